@@ -0,0 +1,17 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+
+// One box against many in a single call, for when a hitbox or trigger has to be
+// tested against a crowd. Same rule as collisionCheck: touching edges don't overlap.
+// Results are a bitmask, bit i of hits[i / 32] set when rect i overlaps. The kernel
+// is picked at first use: AVX2 (8 boxes per step), SSE2 (4) or plain C.
+
+#define AABB_MASK_WORDS(count) (((count) + 31) / 32)
+
+// hits must hold AABB_MASK_WORDS(count) words. Both return the number of overlaps.
+int AABB_OverlapRects(const SDL_Rect *query, const SDL_Rect *rects, int count, Uint32 *hits);
+int AABB_OverlapSoA(const SDL_FRect *query, const float *x, const float *y, const float *w, const float *h,
+                    int count, Uint32 *hits);
+const char *AABB_Backend(void);
@@ -35,9 +35,12 @@ typedef struct Animation{
     bool canBeInterrupted;  // false if animation must finish (combos)
 } Animation;
 
+typedef struct CachedTexture CachedTexture;
+
 typedef struct {
     char* name;             
-    SDL_Texture* texture;
+    SDL_Texture* texture;   // handle->tex, kept here for the draw calls
+    CachedTexture* handle;
     int frameWidth;
     int frameHeight;
 } SpriteSheet;
@@ -6,6 +6,7 @@ typedef struct Player Player;
 
 typedef struct Camera{
     int x, y;
+    int prevX, prevY;   // position one simulation step ago
     int w, h;
     int deadZoneW, deadZoneH;
     float followSpeed;
@@ -16,3 +17,5 @@ typedef struct Camera{
 void Camera_Init(Camera *cam, int viewportW, int viewportH);
 void Camera_Update(Camera *cam, const Player *player, Level *lvl);
 SDL_Rect Camera_GetViewRect(const Camera *cam);
+void Camera_StorePrevious(Camera *cam);
+Camera Camera_Interpolated(const Camera *cam, float alpha);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct Level Level;
+
+#define CHUNK_TILES 16      // chunk edge length in tiles
+
+// One pre-baked block of a static layer. The texture is at source tile
+// resolution and gets scaled up when drawn, same as individual tiles.
+typedef struct LayerChunk {
+    SDL_Texture *tex;       // NULL when not resident
+    int w, h;               // texture size in pixels
+    size_t bytes;
+    bool dirty;             // contents changed since baking
+    bool empty;             // every tile is -1, nothing to bake or draw
+    bool known;             // empty flag is valid
+    struct LayerChunk *prev, *next; // LRU list, most recently used at head
+} LayerChunk;
+
+typedef struct ChunkCache {
+    int layerCount;
+    int chunksX, chunksY;
+    LayerChunk *chunks;     // layerCount * chunksY * chunksX
+    LayerChunk *lruHead;
+    LayerChunk *lruTail;
+    size_t bytesUsed;
+    size_t budgetBytes;
+} ChunkCache;
+
+ChunkCache *ChunkCache_Create(Level *lvl, SDL_Renderer *renderer, size_t budgetBytes);
+void ChunkCache_Destroy(ChunkCache *cache);
+void ChunkCache_RenderLayer(ChunkCache *cache, Level *lvl, int layerIndex, SDL_Renderer *renderer, const SDL_Rect *view);
+void ChunkCache_InvalidateTile(ChunkCache *cache, int layerIndex, int col, int row);
+void ChunkCache_InvalidateAll(ChunkCache *cache);
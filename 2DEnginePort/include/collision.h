@@ -9,6 +9,7 @@
 
 typedef struct {
     float x, y;              // world position
+    float prevX, prevY;      // position one simulation step ago, rendering interpolates from here
     float velocity_x, velocity_y;
     SDL_Rect collisionRect;  // local collision box
     float colliderOffsetX, colliderOffsetY;
@@ -17,6 +18,14 @@ typedef struct {
 } PhysicsBody;
 
 
+// Where a sweep through the tile grid stopped
+typedef struct {
+    bool hit;
+    float time;              // fraction of the motion before contact, 1 when nothing was hit
+    float normalX, normalY;  // contact normal, e.g. (0, -1) for a floor
+    int col, row;            // cell that was hit
+} SweepHit;
+
 typedef struct Player Player;
 typedef struct Level Level; 
 typedef struct Layer Layer;
@@ -26,4 +35,11 @@ bool isSolidTileInLayer(Layer *layer, int tileIndex);
 bool collisionCheck(SDL_Rect A, SDL_Rect B);
 void checkEntityTileCollisionsX(PhysicsBody *body, Level *lvl, float deltaTime);
 void checkEntityTileCollisionsY(PhysicsBody *body, Level *lvl, float deltaTime);
-bool hasCeilingAbove(const PhysicsBody *body, Level *lvl, int extraHeight);
\ No newline at end of file
+bool hasCeilingAbove(const PhysicsBody *body, Level *lvl, int extraHeight);
+bool PhysicsBody_SweepX(const PhysicsBody *body, const Level *lvl, float dx, SweepHit *hit);
+bool PhysicsBody_SweepY(const PhysicsBody *body, const Level *lvl, float dy, SweepHit *hit);
+void PhysicsBody_Move(PhysicsBody *body, const Level *lvl, float deltaTime, SweepHit *hitX, SweepHit *hitY);
+void moveBoxThroughTiles(const Level *lvl, float *x, float *y, float w, float h, float *vx, float *vy,
+                         float deltaTime, SweepHit *hitX, SweepHit *hitY, int *probes);
+void PhysicsBody_StorePrevious(PhysicsBody *body);
+void PhysicsBody_RenderOffset(const PhysicsBody *body, float alpha, float *dx, float *dy);
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+
+// Named per-frame engine counters: how much work a frame did, next to the profiler's
+// how long it took. Each counter's value restarts every frame and the last
+// COUNTERS_HISTORY frames are kept. Frames are delimited by the profiler
+// (Profiler_BeginFrame/EndFrame), and like the profiler the COUNTER_* macros compile
+// to nothing without ENGINE_PROFILE.
+//
+// Counting from the main thread is a plain add, other threads (loaders, decoders,
+// jobs) go through a spinlock and land in the frame that is running when they count.
+
+#define COUNTERS_MAX 32
+#define COUNTERS_HISTORY 120            // frames, same as the profiler ring
+
+// Built-in counters, registered by Counters_Init. Counters_Register adds more.
+typedef enum {
+    COUNTER_DRAW_CALLS,                 // SDL_RenderCopy(Ex) and SDL_RenderGeometry calls
+    COUNTER_TEXTURE_SWITCHES,           // draws using a different texture than the draw before
+    COUNTER_TILES_VISITED,              // visible cells walked by renderLayer
+    COUNTER_TILES_DRAWN,                // non-empty cells among them
+    COUNTER_COLLISION_PROBES,           // grid cells tested by the tile collision checks and sweeps
+    COUNTER_BYTES_READ,                 // level files, JSON and CSVs read or mapped
+    COUNTER_IMAGES_DECODED,
+    COUNTER_PHYSICS_BODIES,             // bodies moved by PhysicsWorld_Step
+    COUNTER_RAY_CELLS,                  // grid cells walked by raycasts
+    COUNTER_BUILTIN_COUNT
+} CounterId;
+
+typedef struct CounterStats {
+    Uint64 last;                        // last finished frame
+    Uint64 min, max;
+    double avg;
+    Uint64 total;                       // since Counters_Init, startup included
+    int samples;
+} CounterStats;
+
+void Counters_Init(void);
+int Counters_Register(const char *name);
+int Counters_Find(const char *name);
+int Counters_Count(void);
+const char *Counters_Name(int id);
+
+void Counters_BeginFrame(void);
+void Counters_EndFrame(void);
+void Counters_Add(int id, Uint64 amount);
+void Counters_CountDraw(SDL_Texture *texture);
+void Counters_GetStats(int id, CounterStats *stats);
+
+#ifdef ENGINE_PROFILE
+#define COUNTER_ADD(id, amount)     Counters_Add((id), (Uint64)(amount))
+#define COUNTER_DRAW(texture)       Counters_CountDraw(texture)
+#else
+#define COUNTER_ADD(id, amount)     ((void)0)
+#define COUNTER_DRAW(texture)       ((void)0)
+#endif
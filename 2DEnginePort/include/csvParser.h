@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Streaming parser for tile layer CSVs (signed integers, one map row per line).
+// Reads in large blocks, finds delimiters 16 bytes at a time and converts numbers
+// by hand, so it handles any row length and has no hidden state (safe to run on
+// several threads at once). CRLF line endings, trailing commas and blank lines are
+// accepted; anything else that doesn't match the expected size is an error.
+
+typedef enum {
+    CSV_OK = 0,
+    CSV_ERR_OPEN,
+    CSV_ERR_READ,
+    CSV_ERR_NOMEM,
+    CSV_ERR_BAD_CHAR,           // not a digit, sign, delimiter or whitespace
+    CSV_ERR_EMPTY_FIELD,        // ",," in the middle of a row
+    CSV_ERR_OVERFLOW,           // doesn't fit in an int
+    CSV_ERR_TOO_MANY_COLUMNS,
+    CSV_ERR_TOO_FEW_COLUMNS,
+    CSV_ERR_TOO_MANY_ROWS,
+    CSV_ERR_TOO_FEW_ROWS
+} CsvStatus;
+
+typedef struct {
+    CsvStatus status;
+    int row;                // 1-based row where parsing stopped / failed
+    int column;             // 1-based column where parsing stopped / failed
+    int rowsRead;           // non-blank rows seen
+    size_t bytesRead;
+} CsvResult;
+
+// out must hold rows * cols ints
+CsvStatus CSV_ParseTiles(const char *path, int rows, int cols, int *out, CsvResult *result);
+CsvStatus CSV_ParseTilesBuffer(const char *data, size_t size, int rows, int cols, int *out, CsvResult *result);
+const char *CSV_StatusString(CsvStatus status);
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <SDL.h>
+
+// Tiny built-in 3x5 pixel font for debug overlays, so they don't need SDL_ttf or a
+// font file. Upper case letters, digits and . : - _ / ( ) %; lower case is drawn
+// upper case, anything else as a blank.
+#define DEBUGTEXT_GLYPH_W 3
+#define DEBUGTEXT_GLYPH_H 5
+
+void DebugText_Draw(SDL_Renderer *renderer, int x, int y, int scale, const char *text);
+int DebugText_Width(const char *text, int scale);
@@ -63,6 +63,7 @@ void Enemy_Update(enemy* enemy, float deltaTime, Player* player);
 void Enemy_UpdatePhysics(enemy* enemy);
 void Enemy_Attack(enemy* enemy, Player *player);
 
-void Enemy_Render(enemy* enemy, mainSystems* system);
+// Queues the enemy's frame on the batch (SPRITE_LAYER_ENEMIES), like Player_Render
+void Enemy_Render(enemy* enemy, SpriteBatch* batch, const Camera* camera);
 void Enemy_Die(enemy* enemy);
 void Enemy_Unload(enemy* enemy);
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+
+#define FRAMEPACER_HISTORY 120     // frames kept for the statistics, ~2s at 60 FPS
+
+typedef struct {
+    float avgMs;
+    float minMs;
+    float maxMs;
+    float p99Ms;                    // 99th percentile frame time
+    float avgWorkMs;                // time from BeginFrame to EndFrame, before waiting
+    float fps;                      // 1000 / avgMs
+    int samples;
+} FrameStats;
+
+// Holds the main loop to a target frame rate using the performance counter. Sleeps
+// with SDL_Delay while there's time to spare and yields/spins for the last stretch,
+// so frames land on the deadline instead of on the next millisecond tick.
+typedef struct FramePacer {
+    Uint64 frequency;
+    Uint64 frameTicks;              // counter ticks per frame, 0 = uncapped
+    Uint64 deadline;                // when the current frame should end
+    Uint64 frameStart;
+    bool vsync;                     // SDL_RenderPresent already waits for the display
+    float frameMs[FRAMEPACER_HISTORY];
+    float workMs[FRAMEPACER_HISTORY];
+    int historyIndex;
+    int historyCount;
+} FramePacer;
+
+void FramePacer_Init(FramePacer *pacer, int targetFps, bool vsync);
+void FramePacer_SetTarget(FramePacer *pacer, int targetFps, bool vsync);
+float FramePacer_BeginFrame(FramePacer *pacer);
+void FramePacer_EndFrame(FramePacer *pacer);
+void FramePacer_GetStats(const FramePacer *pacer, FrameStats *stats);
@@ -4,13 +4,21 @@
 #include <stdbool.h>
 #include "settings.h"
 #include "camera.h"
+#include "framePacer.h"
+#include "spriteBatch.h"
 
 
 // Forward declarations 
 typedef struct Player Player;
 typedef struct Level Level;
 typedef struct TextureCache TextureCache;
+typedef struct ImageDecoder ImageDecoder;
+typedef struct JobSystem JobSystem;
+typedef struct PhysicsWorld PhysicsWorld;
+typedef struct SpatialHash SpatialHash;
 typedef struct LevelPaths LevelPaths;
+typedef struct LevelLoader LevelLoader;
+typedef struct LevelPrefetcher LevelPrefetcher;
 
 
 typedef struct mainSystems {
@@ -40,22 +48,33 @@ typedef enum {
 typedef struct GameManager{
     mainSystems mainSystems;
     char* windowName;
-    TextureCache *cache;   // TODO
+    TextureCache *cache;   // every loaded image, shared by path
+    ImageDecoder *decoder; // worker pool decoding images for the cache and the level loader
+    JobSystem *jobs;       // work-stealing pool shared by engine subsystems
+    PhysicsWorld *physics; // every moving body, stepped once per simulation step
+    SpatialHash *broadphase; // cells of the physics bodies, for entity vs entity queries
     Level *level;          // Current level
     Player *player;        // Single player instance
 
     GameSettings settings;
     Camera camera;
+    FramePacer pacer;
+    SpriteBatch sprites;   // characters and effects, drawn after the level each frame
     GameState state;       // TODO
     char *currentLevelName;
-    float deltaTime;
+    float deltaTime;       // length of one simulation step, in seconds
+    double simAccumulator; // frame time not yet simulated, in seconds
+    float renderAlpha;     // how far the frame is between the previous and current step, 0..1
     bool running;
     LevelPaths *levelPaths; 
+    LevelLoader *levelLoader; // background load in progress, swapped in when done
+    LevelPrefetcher *prefetcher; // stages the next level while this one plays
 
 } GameManager;
 
 // --- Lifecycle ---
 GameManager *GameManager_Create(const char *settingsPath, const char *windowName);
+GameManager *GameManager_CreateWithLevel(const char *settingsPath, const char *windowName, const char *levelName);
 void GameManager_Destroy(GameManager *gm, int exitCode);
 
 // --- State management ---
@@ -64,10 +83,13 @@ GameState GameManager_GetState(GameManager *gm);
 
 // --- Level management ---
 bool GameManager_LoadLevel(GameManager *gm, const char *levelName);
+bool GameManager_LoadLevelAsync(GameManager *gm, const char *levelName);
+void GameManager_UpdateLevelLoad(GameManager *gm);
+const char *GameManager_NextLevelName(GameManager *gm);
 void GameManager_UnloadLevel(GameManager *gm);
 
 // --- Main loop hooks ---
 void GameManager_HandleInput(GameManager *gm);
-void GameManager_Update(GameManager *gm, float deltaTime);
+void GameManager_Update(GameManager *gm, float frameTime);
 void GameManager_Render(GameManager *gm);
 
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+
+// Pending decode of one image file. Returned by ImageDecoder_Submit and released by
+// the submitter; the worker holds its own reference until the decode is finished.
+typedef struct ImageFuture {
+    char *path;
+    SDL_Surface *surf;          // converted to the decoder's pixel format, NULL on failure
+    SDL_atomic_t done;
+    SDL_atomic_t refs;
+    struct ImageFuture *next;   // job queue link
+} ImageFuture;
+
+// Worker pool that turns image files into surfaces in the renderer's native pixel
+// format, so uploads are straight copies. Any thread may submit and wait.
+typedef struct ImageDecoder {
+    SDL_Thread **threads;
+    int threadCount;
+    Uint32 format;
+    SDL_mutex *lock;
+    SDL_cond *jobReady;         // signalled when a job is queued or on shutdown
+    SDL_cond *jobDone;          // broadcast whenever a future completes
+    ImageFuture *queueHead;
+    ImageFuture *queueTail;
+    bool quit;
+} ImageDecoder;
+
+ImageDecoder *ImageDecoder_Create(SDL_Renderer *renderer, int threadCount);
+void ImageDecoder_Destroy(ImageDecoder *decoder);
+
+ImageFuture *ImageDecoder_Submit(ImageDecoder *decoder, const char *path);
+bool ImageFuture_IsReady(const ImageFuture *future);
+SDL_Surface *ImageFuture_Wait(ImageDecoder *decoder, ImageFuture *future);
+SDL_Surface *ImageFuture_TakeSurface(ImageFuture *future);
+void ImageFuture_Release(ImageFuture *future);
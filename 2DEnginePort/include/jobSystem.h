@@ -0,0 +1,63 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+
+typedef void (*JobFunc)(void *data);
+typedef void (*JobRangeFunc)(void *data, int begin, int end);
+
+typedef struct JobContinuation JobContinuation;
+
+// Counts unfinished jobs. Zero-initialise it (JobCounter c = {0};), hand it to the
+// jobs that should be waited on, then JobSystem_Wait on it or use it as a dependency.
+typedef struct JobCounter {
+    SDL_atomic_t value;
+    SDL_SpinLock lock;
+    JobContinuation *continuations;  // jobs released when value drops to zero
+} JobCounter;
+
+typedef struct Job {
+    JobFunc func;
+    void *data;
+    JobCounter *counter;    // decremented once func returns, may be NULL
+} Job;
+
+// Growable ring of jobs. The owning thread pushes and pops at the tail, idle
+// threads steal from the head.
+typedef struct JobDeque {
+    Job *jobs;
+    int capacity;           // power of two
+    int head, tail;         // head <= tail, indices wrap through capacity
+    SDL_SpinLock lock;
+} JobDeque;
+
+// One worker thread per core but one; the main thread owns deque 0 and works on
+// it whenever it waits. Threads that aren't part of the pool (the level loader)
+// can submit too, their jobs are spread over the worker deques.
+typedef struct JobSystem {
+    SDL_Thread **threads;
+    JobDeque *deques;       // [0] main thread, [1..threadCount] workers
+    int threadCount;
+    SDL_TLSID workerSlot;   // deque index + 1 of the calling thread, 0 if it has none
+    SDL_threadID mainThread;
+    SDL_sem *wake;
+    SDL_atomic_t sleeping;
+    SDL_atomic_t nextExternal;
+    SDL_atomic_t quit;
+
+    // Renderer calls have to happen on the main thread, jobs queue them here
+    SDL_mutex *mainLock;
+    Job *mainJobs;
+    int mainCount, mainCapacity;
+} JobSystem;
+
+JobSystem *JobSystem_Create(int threadCount);
+void JobSystem_Destroy(JobSystem *js);
+
+void JobSystem_Run(JobSystem *js, JobFunc func, void *data, JobCounter *counter);
+void JobSystem_RunAfter(JobSystem *js, JobCounter *dependency, JobFunc func, void *data, JobCounter *counter);
+void JobSystem_RunOnMain(JobSystem *js, JobFunc func, void *data, JobCounter *counter);
+void JobSystem_Wait(JobSystem *js, JobCounter *counter);
+void JobSystem_DrainMain(JobSystem *js);
+void JobSystem_ParallelFor(JobSystem *js, int count, int minBatch, JobRangeFunc func, void *data);
+bool JobCounter_IsDone(JobCounter *counter);
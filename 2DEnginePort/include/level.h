@@ -1,6 +1,8 @@
 #pragma once
 
 #include "constants.h"
+#include "tileBatch.h"
+#include "chunkCache.h"
 #include <SDL.h>
 #include <SDL_image.h>
 #include <stdbool.h>
@@ -10,6 +12,11 @@
 struct mainSystems;
 typedef struct Player Player;
 typedef struct GameManager GameManager;
+typedef struct Camera Camera;
+typedef struct LevelBinMapping LevelBinMapping;
+typedef struct TextureCache TextureCache;
+typedef struct CachedTexture CachedTexture;
+typedef struct TextureAtlas TextureAtlas;
 
 typedef struct {
     char *name;  // e.g., "level1"
@@ -24,19 +31,46 @@ typedef struct LevelPaths{
 } LevelPaths;
 
 
+// Decoded image waiting for its texture. Filled off the main thread, uploaded in row bands.
+typedef struct {
+    SDL_Surface *surf;      // renderer-native pixels, NULL once the texture is complete
+    int rowsUploaded;
+} StagedImage;
+
 typedef struct {
     char *id;              
-    SDL_Texture *tex;
+    char *imagePath;
+    SDL_Texture *tex;       // handle->tex once uploaded, until then the texture being filled
+    CachedTexture *handle;
     int tileSize;           // in pixels 
     int tilesPerRow;        // how many tiles in source image row
     float scale;            // how much to scale when rendering
+    int texW, texH;         // texture size in pixels, for normalized UVs when batching
+    int originX, originY;   // top left of tile 0 in tex, moves when packed into the level atlas
+    int tileStride;         // distance between neighbouring tiles in tex, tileSize plus atlas padding
+    StagedImage staged;
 } Tileset;
 
+// Source rect of a tile in the tileset's texture
+static inline SDL_Rect Tileset_TileRect(const Tileset *ts, int tileIndex)
+{
+    SDL_Rect src = {
+        ts->originX + (tileIndex % ts->tilesPerRow) * ts->tileStride,
+        ts->originY + (tileIndex / ts->tilesPerRow) * ts->tileStride,
+        ts->tileSize,
+        ts->tileSize
+    };
+    return src;
+}
+
 typedef struct Layer {
     char *csvPath;          // path to load tile indices from
     int *tiles;             // dynamic array LEVEL_ROWS * LEVEL_COLS
     char *tileset_id;       // which tileset to use for this layer
+    int tilesetIndex;       // tileset_id resolved at load time, -1 if it doesn't exist
+    int scaledTileSize;     // tileSize * scale of that tileset, in world pixels
     bool collidable;         // Is the layer collidable
+    bool isStatic;          // never changes at runtime, drawn from pre-baked chunks (defaults to !collidable)
     int *solidTiles;        // list of tile indices that are considered solid for this layer
     int solidCount;         // number of items in solidTiles
 } Layer;
@@ -44,34 +78,55 @@ typedef struct Layer {
 typedef struct {
     char *imagePath;
     SDL_Texture *tex;
+    CachedTexture *handle;
     float scrollSpeed;
     float scale;
     float offsetY;          // vertical placement
+    StagedImage staged;
 } BackgroundLayer;
 
  struct Level{
     char *name;             // level name
+    char *nextLevel;        // optional "nextLevel" hint, the level most likely loaded after this one
     Tileset *tilesets;     
     int tilesetCount;
     Layer *layers;         // dynamic array of layer descriptions
     int layerCount;
+    Uint32 *solidGrid;     // one bit per cell (row * levelColumns + col), merged from all collidable layers
+    TileBatch tileBatch;   // scratch geometry reused by every layer, every frame
+    ChunkCache *chunkCache; // baked chunks of static layers, created on first render
+    TextureAtlas *atlas;    // every tileset packed together once uploaded, NULL draws from the tileset textures
+    LevelBinMapping *mapping; // set when loaded from a compiled .lvlbin, owns the tile arrays
     BackgroundLayer *bgs;
     int bgCount;
     int spawnColumn;
     int levelRows;
     int levelColumns;
+    int tileSize;           // common scaled tile size, the collision grid cell size
+    int pixelWidth;         // levelColumns * tileSize
+    int pixelHeight;        // levelRows * tileSize
 } typedef Level;
 
 void debug_draw_collidable_tiles(Level *lvl, SDL_Renderer *renderer, int cameraX, int cameraY);
 LevelPaths *levelPaths(char *path);
 void freeLevelPaths(LevelPaths *lp);
-SDL_Texture *getTextureCached(SDL_Renderer *renderer, const char *path);
 char *read_whole_file(const char *path);
 Level *loadLevelFromJSON(const char *jsonPath, GameManager *gm);
+Level *level_parseJSON(const char *jsonPath);
+Level *level_loadStaged(const char *jsonPath, TextureCache *textures, size_t capBytes);
+bool level_decodeImages(Level *lvl, TextureCache *textures);
+size_t level_stagedBytes(const Level *lvl);
+bool level_resolve(Level *lvl);
+Tileset *level_getLayerTileset(Level *lvl, const Layer *layer);
+bool level_uploadTextures(Level *lvl, TextureCache *textures, Uint64 deadline, bool *done);
 int getLevelTileWidth(Level *lvl);
 bool level_isTileSolid(Level *lvl, int worldX, int worldY);
+bool level_buildSolidGrid(Level *lvl);
+bool level_isCellSolid(const Level *lvl, int col, int row);
+void level_setTile(Level *lvl, int layerIndex, int col, int row, int tileIndex);
 void unloadLevel(Level *level);
-void renderLevel(GameManager *gm);
+void renderLevel(GameManager *gm, const Camera *view);
+bool renderLayer(Layer *layer, Level *lvl, SDL_Renderer *renderer, const SDL_Rect *view, bool batched);
 int *loadLayerCSV(const char *csvPath, int levelRows, int levelCols);
 void spawnPlayerOnAnyCollidable(Player *p, int spawnCol, Level *lvl, bool searchFromTop);
 Tileset *findTileset(Level *lvl, const char *id);
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct Level Level;
+typedef struct LevelBinMapping LevelBinMapping;
+
+// Compiled level file (.lvlbin), written by tools/levelCompiler.c.
+// Everything is little-endian, offsets are from the start of the file and
+// tile arrays are 16 byte aligned so Layer::tiles can point straight into the mapping.
+//
+//   LevelBinHeader
+//   LevelBinTileset[tilesetCount]
+//   LevelBinLayer[layerCount]
+//   LevelBinBackground[bgCount]
+//   string table (NUL terminated, referenced by offset)
+//   solid tile sets, Sint32[solidCount] per layer
+//   tile arrays, Sint32[levelRows * levelColumns] per layer
+
+#define LEVELBIN_MAGIC   0x4E49424Cu    // "LBIN"
+#define LEVELBIN_VERSION 2u
+#define LEVELBIN_EXT     ".lvlbin"
+
+#define LEVELBIN_LAYER_COLLIDABLE 0x1u
+#define LEVELBIN_LAYER_STATIC     0x2u
+
+typedef struct {
+    Uint32 magic;
+    Uint32 version;
+    Uint32 fileSize;
+    Sint32 levelRows;
+    Sint32 levelColumns;
+    Sint32 spawnColumn;
+    Uint32 name;            // string offset
+    Uint32 tilesetCount;
+    Uint32 tilesetOffset;
+    Uint32 layerCount;
+    Uint32 layerOffset;
+    Uint32 bgCount;
+    Uint32 bgOffset;
+    Uint32 stringsOffset;
+    Uint32 stringsSize;
+    Uint32 nextLevel;       // string offset, empty when the level has no hint
+} LevelBinHeader;
+
+typedef struct {
+    Uint32 id;              // string offset
+    Uint32 image;           // string offset
+    Sint32 tileSize;
+    Sint32 tilesPerRow;
+    float scale;
+} LevelBinTileset;
+
+typedef struct {
+    Uint32 csvPath;         // string offset
+    Uint32 tilesetId;       // string offset
+    Uint32 flags;           // LEVELBIN_LAYER_*
+    Uint32 solidCount;
+    Uint32 solidOffset;
+    Uint32 tilesOffset;
+} LevelBinLayer;
+
+typedef struct {
+    Uint32 image;           // string offset
+    float scrollSpeed;
+    float scale;
+    float offsetY;
+} LevelBinBackground;
+
+bool LevelBin_PathFor(const char *jsonPath, char *out, size_t outSize);
+bool LevelBin_IsFresh(const char *binPath, const char *jsonPath);
+bool LevelBin_Write(const Level *lvl, const char *binPath);
+Level *LevelBin_Load(const char *binPath);
+void LevelBin_Unmap(LevelBinMapping *mapping);
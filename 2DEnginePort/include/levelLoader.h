@@ -0,0 +1,44 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct Level Level;
+typedef struct TextureCache TextureCache;
+
+typedef enum {
+    LEVELLOAD_IDLE,
+    LEVELLOAD_WORKING,      // loader thread is parsing files and decoding images
+    LEVELLOAD_UPLOADING,    // main thread is creating textures a few bands per frame
+    LEVELLOAD_READY,        // level is complete, waiting to be taken
+    LEVELLOAD_FAILED
+} LevelLoadState;
+
+// Loads one level in the background. The thread does everything that doesn't need
+// the renderer (level_loadStaged), the main thread finishes the textures within a
+// per-frame budget and then hands the level over with LevelLoader_Take.
+typedef struct LevelLoader {
+    SDL_Thread *thread;
+    SDL_atomic_t workerDone;
+    LevelLoadState state;
+    char *levelName;
+    char *jsonPath;
+    Level *level;           // owned by the loader until taken
+    TextureCache *textures; // finished images go here, resident ones aren't decoded again
+    size_t capBytes;        // staged memory the thread may use, 0 for no limit (see level_loadStaged)
+    bool dropCap;           // claimed while staging under a cap: once the thread is done, drop
+                            // the cap and load again if the capped attempt failed
+    Uint64 startCounter;
+} LevelLoader;
+
+LevelLoader *LevelLoader_Create(TextureCache *textures);
+void LevelLoader_Destroy(LevelLoader *loader);
+
+bool LevelLoader_Start(LevelLoader *loader, const char *levelName, const char *jsonPath);
+LevelLoadState LevelLoader_Poll(LevelLoader *loader);
+LevelLoadState LevelLoader_Update(LevelLoader *loader, float budgetMs);
+Level *LevelLoader_Take(LevelLoader *loader, char **levelName);
+Level *LevelLoader_Finish(LevelLoader *loader, char **levelName);
+bool LevelLoader_Discard(LevelLoader *loader);
+bool LevelLoader_IsBusy(const LevelLoader *loader);
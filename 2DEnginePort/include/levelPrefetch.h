@@ -0,0 +1,24 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct LevelLoader LevelLoader;
+typedef struct TextureCache TextureCache;
+
+// Stages the level most likely to come next (parsed, decoded, collision grid built)
+// while the current one is playing. A real load of that level takes over the staged
+// loader, so only the texture upload is left.
+typedef struct LevelPrefetcher {
+    LevelLoader *loader;
+    char *target;           // last level asked for, not retried after being dropped
+    size_t capBytes;
+    size_t stagedBytes;
+} LevelPrefetcher;
+
+LevelPrefetcher *LevelPrefetcher_Create(size_t capBytes, TextureCache *textures);
+void LevelPrefetcher_Destroy(LevelPrefetcher *pf);
+
+void LevelPrefetcher_Update(LevelPrefetcher *pf, const char *levelName, const char *jsonPath);
+LevelLoader *LevelPrefetcher_Claim(LevelPrefetcher *pf, const char *levelName, LevelLoader *spare);
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "collision.h"
+
+typedef struct Level Level;
+typedef struct JobSystem JobSystem;
+
+// Refers to a body in a PhysicsWorld. The low bits pick a slot, the high bits count
+// how often the slot was reused, so a handle to a removed body stays invalid.
+typedef Uint32 BodyHandle;
+#define BODY_NONE 0
+
+#define PHYSICS_INDEX_BITS 20
+#define PHYSICS_MAX_BODIES ((1 << PHYSICS_INDEX_BITS) - 1)
+#define PHYSICS_SLOT(handle) ((handle) & ((1u << PHYSICS_INDEX_BITS) - 1))  // 1 based, 0 for BODY_NONE
+#define PHYSICS_PARALLEL_MIN 256    // bodies per batch when the step is split across cores
+
+// Body flags
+enum {
+    BODY_COLLIDES    = 1 << 0,      // stopped by solid tiles, otherwise moves freely
+    BODY_ON_GROUND   = 1 << 1,      // set on landing, cleared by the owner (when it jumps)
+    BODY_HIT_FLOOR   = 1 << 2,      // contacts during the last step
+    BODY_HIT_CEILING = 1 << 3,
+    BODY_HIT_WALL    = 1 << 4,
+    BODY_CONTACTS    = BODY_HIT_FLOOR | BODY_HIT_CEILING | BODY_HIT_WALL
+};
+
+// What a body is, for filtering broadphase queries with a mask
+enum {
+    BODY_CATEGORY_DEFAULT    = 1 << 0,
+    BODY_CATEGORY_PLAYER     = 1 << 1,
+    BODY_CATEGORY_ENEMY      = 1 << 2,
+    BODY_CATEGORY_PROJECTILE = 1 << 3,
+    BODY_CATEGORY_TRIGGER    = 1 << 4
+};
+#define BODY_CATEGORY_ALL 0xFFFFFFFFu
+
+// Every moving body in the game, stored as parallel arrays so the step walks each
+// field linearly. Bodies are packed at [0, count); removing one moves the last body
+// into its place, handles go through `slots` to find them.
+typedef struct PhysicsWorld {
+    float *x, *y;                   // top left of the box, world pixels
+    float *vx, *vy;                 // pixels per second
+    float *w, *h;                   // box size
+    float *gravity;                 // pixels per second squared, per body
+    float *maxFallSpeed;
+    Uint8 *flags;
+    Uint32 *categories;             // BODY_CATEGORY_* bits
+    BodyHandle *handles;            // handle of the body at each dense index
+    int count, capacity;
+
+    Uint32 *slots;                  // slot -> dense index, or the next free slot while unused
+    Uint32 *generations;
+    int slotCount, slotCapacity;
+    Uint32 freeSlot;                // head of the free slot list, 0 when empty (slots are 1 based)
+} PhysicsWorld;
+
+PhysicsWorld *PhysicsWorld_Create(int capacity);
+void PhysicsWorld_Destroy(PhysicsWorld *world);
+
+BodyHandle PhysicsWorld_Add(PhysicsWorld *world, float x, float y, float w, float h, Uint8 flags);
+void PhysicsWorld_Remove(PhysicsWorld *world, BodyHandle handle);
+int PhysicsWorld_Index(const PhysicsWorld *world, BodyHandle handle);
+void PhysicsWorld_SetGravity(PhysicsWorld *world, BodyHandle handle, float gravity, float maxFallSpeed);
+void PhysicsWorld_SetCategory(PhysicsWorld *world, BodyHandle handle, Uint32 categories);
+bool PhysicsWorld_GetRect(const PhysicsWorld *world, BodyHandle handle, SDL_Rect *rect);
+void PhysicsWorld_WriteBody(PhysicsWorld *world, BodyHandle handle, const PhysicsBody *body);
+void PhysicsWorld_ReadBody(const PhysicsWorld *world, BodyHandle handle, PhysicsBody *body);
+void PhysicsWorld_Step(PhysicsWorld *world, const Level *lvl, float deltaTime, JobSystem *jobs);
@@ -2,6 +2,7 @@
 
 #include "collision.h"
 #include "animation.h"
+#include "physicsWorld.h"
 
 #include <SDL.h>
 #include <stdbool.h>
@@ -11,6 +12,10 @@ typedef struct Level Level;
 struct mainSystems;
 typedef struct GameSettings GameSettings;
 typedef struct Camera Camera;
+typedef struct TextureCache TextureCache;
+typedef struct SpriteBatch SpriteBatch;
+typedef struct TextureAtlas TextureAtlas;
+typedef struct SpatialHash SpatialHash;
 
 // Player States
 typedef enum {
@@ -68,7 +73,9 @@ typedef struct Player{
     // Collision
     CollisionProfile *collisionProfiles;
     int profileCount;
-    PhysicsBody body;
+    PhysicsBody body;          // the player's copy, written to and read back from the world every step
+    PhysicsWorld *world;       // NULL moves the body directly
+    BodyHandle bodyHandle;
 
     // Attacks
     SDL_Rect *attackRects;     // runtime positioned hitboxes
@@ -83,6 +90,7 @@ typedef struct Player{
 
     SpriteSheet *sheets;
     int sheetCount;
+    TextureAtlas *atlas;      // sheets packed together, SpriteSheet::texture points into it
     float spriteScale;        // visual scaling factor
 
     PlayerAnimations anims;
@@ -107,18 +115,24 @@ typedef struct Player{
 
 // Lifecycle
 
-bool Player_LoadConfig(Player *player, struct mainSystems *systems, const char *filePath);
+bool Player_LoadConfig(Player *player, TextureCache *textures, const char *filePath);
 void Player_Destroy(Player *player);
 
 // Main loop
 
+bool Player_AttachPhysics(Player *player, PhysicsWorld *world);
 void Player_Update(Player *player, float deltatime, Level *lvl);
-void Player_Render(const Player *player, const struct mainSystems *systems, const Camera *camera, bool debug);
+void Player_AfterPhysics(Player *player, float deltaTime, Level *lvl);
+int Player_FindAttackTargets(const Player *player, SpatialHash *broadphase, Uint32 categories,
+                             BodyHandle *out, int maxOut);
+void Player_Render(const Player *player, SpriteBatch *batch, const Camera *camera, float alpha);
+void Player_RenderDebug(const Player *player, SDL_Renderer *renderer, const Camera *camera, float alpha);
 
 
 // updates
 
 void Player_HandleInput(Player *player);
+void Player_HandleInputState(Player *player, const Uint8 *state);
 void Player_UpdatePhysics(Player *player, float deltaTime, Level *lvl);
 void Player_UpdateAnimation(Player *player, float deltaTime);
 void Player_UpdateAttackHitbox(Player *player);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+
+// Hierarchical frame profiler. Scopes nest, each frame keeps its tree of scopes and
+// the last PROFILER_FRAMES frames stay in a ring for the overlay and trace export.
+// Scopes recorded after PROFILE_INIT and before the first frame land in a separate
+// startup frame.
+//
+// The PROFILE_* macros only do something when ENGINE_PROFILE is defined (Debug builds
+// and the Linux Makefile set it), without it they compile to nothing. Only the main thread is recorded,
+// scopes opened on other threads are ignored. Frames also delimit the counters in
+// counters.h.
+//
+//     PROFILE_BEGIN("Update");
+//     ...
+//     PROFILE_END();
+//
+//     PROFILE_SCOPE("Physics") {
+//         ...     // don't return or break out of the block, the scope wouldn't close
+//     }
+
+#define PROFILER_FRAMES 120             // ~2s at 60 FPS
+#define PROFILER_MAX_SCOPES 128         // per frame, scopes past this are dropped
+#define PROFILER_MAX_DEPTH 32
+
+typedef struct ProfileScope {
+    const char *name;                   // not copied, pass string literals
+    Uint64 start, end;                  // performance counter, end 0 while still open
+    Sint16 parent;                      // index in the same frame, -1 at the top level
+    Sint16 depth;
+} ProfileScope;
+
+typedef struct ProfileFrame {
+    Uint64 start, end;
+    Uint32 number;                      // 0 is the startup frame
+    int count;
+    ProfileScope scopes[PROFILER_MAX_SCOPES];
+} ProfileFrame;
+
+void Profiler_Init(void);
+void Profiler_BeginFrame(void);
+void Profiler_EndFrame(void);
+void Profiler_Begin(const char *name);
+void Profiler_End(void);
+
+const ProfileFrame *Profiler_LastFrame(void);
+const ProfileFrame *Profiler_StartupFrame(void);
+double Profiler_TicksToMs(Uint64 ticks);
+void Profiler_RenderOverlay(SDL_Renderer *renderer, int x, int y);
+bool Profiler_ExportTrace(const char *path);
+
+#ifdef ENGINE_PROFILE
+#define PROFILE_INIT()          Profiler_Init()
+#define PROFILE_FRAME_BEGIN()   Profiler_BeginFrame()
+#define PROFILE_FRAME_END()     Profiler_EndFrame()
+#define PROFILE_BEGIN(name)     Profiler_Begin(name)
+#define PROFILE_END()           Profiler_End()
+#define PROFILE_SCOPE(name)     for (int profileOnce_ = (Profiler_Begin(name), 1); profileOnce_; profileOnce_ = (Profiler_End(), 0))
+#else
+#define PROFILE_INIT()          ((void)0)
+#define PROFILE_FRAME_BEGIN()   ((void)0)
+#define PROFILE_FRAME_END()     ((void)0)
+#define PROFILE_BEGIN(name)     ((void)0)
+#define PROFILE_END()           ((void)0)
+#define PROFILE_SCOPE(name)
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+
+typedef struct Level Level;
+typedef struct JobSystem JobSystem;
+
+#define RAYCAST_PARALLEL_MIN 64     // rays per batch when a batch is split across cores
+
+// A ray through the collision grid, in world pixels
+typedef struct Ray {
+    float originX, originY;
+    float dirX, dirY;               // doesn't have to be normalized
+    float maxDistance;
+} Ray;
+
+// Where a ray stopped
+typedef struct RayHit {
+    bool hit;
+    float distance;                 // from the origin, maxDistance when nothing was hit
+    float x, y;                     // contact point, or the end of the ray
+    int col, row;                   // solid cell that was hit
+    int normalX, normalY;           // face the ray entered through, e.g. (0, -1) for the top of a floor
+                                    // tile; (0, 0) when the origin is inside a solid cell
+} RayHit;
+
+// Walks the cells of level_isCellSolid along the ray, one cell per step
+// (Amanatides-Woo), so the cost is bounded by the cells the ray crosses.
+bool Raycast_Cast(const Level *lvl, float originX, float originY, float dirX, float dirY, float maxDistance,
+                  RayHit *hit);
+bool Raycast_LineOfSight(const Level *lvl, float fromX, float fromY, float toX, float toY);
+int Raycast_Batch(const Level *lvl, const Ray *rays, int count, RayHit *hits, JobSystem *jobs);
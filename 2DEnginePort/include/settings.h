@@ -21,7 +21,13 @@ typedef struct VideoSettings{
     int height;
     bool fullscreen;
     bool vsync;
+    int targetFps;      // frame cap when vsync is off, 0 runs uncapped
     float scale;
+    bool batchTiles;    // submit tile layers through SDL_RenderGeometry instead of one SDL_RenderCopy per tile
+    int chunkCacheMB;   // texture budget for pre-baked static layer chunks, 0 disables them
+    float uploadBudgetMs; // time per frame spent uploading textures of a level loading in the background
+    int prefetchMB;     // memory cap for the staged next level, 0 disables prefetching
+    int textureCacheMB; // images kept resident by the texture cache once nothing references them
 } VideoSettings;
 
 typedef struct {
@@ -32,6 +38,8 @@ typedef struct {
 
 typedef struct {
     bool debugMode;
+    int simulationHz;       // fixed physics/update rate, independent of the frame rate
+    int maxStepsPerFrame;   // catch-up limit after a hitch, anything beyond it is dropped
 } GameplaySettings;
 
 typedef struct GameSettings {
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "physicsWorld.h"
+
+#define SPATIAL_CELL_SIZE 128       // world pixels, a few tiles so most bodies sit in 1-4 cells
+#define SPATIAL_BUCKETS 4096        // power of two
+
+// One body in one cell, chained per bucket
+typedef struct SpatialNode {
+    BodyHandle handle;
+    int cx, cy;
+    int next;                       // next node in the bucket (or free list), -1 at the end
+} SpatialNode;
+
+// Cells a body was inserted into, kept per PhysicsWorld slot
+typedef struct SpatialProxy {
+    BodyHandle handle;              // BODY_NONE while the slot isn't in the hash
+    int minX, minY, maxX, maxY;     // inclusive cell range
+    Uint32 stamp;                   // last query that returned it, to report bodies once
+} SpatialProxy;
+
+// Broadphase over the bodies of a PhysicsWorld: a hash from world cell to the bodies
+// touching it. SpatialHash_Sync after each physics step only re-inserts bodies that
+// crossed into other cells. Queries return candidates (bodies in the cells the query
+// touches, filtered by category); run collisionCheck on those as the narrowphase.
+// Queries use per-body stamps, so keep them on one thread.
+typedef struct SpatialHash {
+    float cellSize;
+    int *buckets;                   // first node of each bucket, -1 when empty
+    SpatialNode *nodes;
+    int nodeCount, nodeCapacity;
+    int freeNode;
+    SpatialProxy *proxies;
+    int proxyCapacity;
+    Uint32 stamp;
+} SpatialHash;
+
+SpatialHash *SpatialHash_Create(float cellSize);
+void SpatialHash_Destroy(SpatialHash *hash);
+void SpatialHash_Sync(SpatialHash *hash, const PhysicsWorld *world);
+int SpatialHash_QueryRect(SpatialHash *hash, const PhysicsWorld *world, const SDL_Rect *rect, Uint32 categoryMask,
+                          BodyHandle *out, int maxOut);
+int SpatialHash_QueryPoint(SpatialHash *hash, const PhysicsWorld *world, float x, float y, Uint32 categoryMask,
+                           BodyHandle *out, int maxOut);
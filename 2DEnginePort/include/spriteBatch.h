@@ -0,0 +1,41 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "tileBatch.h"
+
+// Draw order between groups of sprites, lower layers are drawn first
+enum {
+    SPRITE_LAYER_BACK = 0,
+    SPRITE_LAYER_ENEMIES = 10,
+    SPRITE_LAYER_PLAYER = 20,
+    SPRITE_LAYER_EFFECTS = 30
+};
+
+typedef struct Sprite {
+    SDL_Texture *texture;
+    SDL_Rect src;
+    SDL_Rect dst;               // screen space
+    SDL_RendererFlip flip;
+    int layer;
+    int order;                  // submission order, keeps the sort stable
+} Sprite;
+
+// Collects the frame's sprites and draws them sorted by layer, then by texture, so
+// each run of sprites sharing a texture is one SDL_RenderGeometry call. Flips are
+// done by swapping texture coordinates. Within a layer, sprites with different
+// textures don't keep their submission order; put sprites that must overlap in a
+// set order on different layers.
+typedef struct SpriteBatch {
+    Sprite *sprites;
+    int count, capacity;
+    TileBatch geometry;
+    bool useCopy;               // SDL_RenderGeometry failed once, draw with SDL_RenderCopyEx
+} SpriteBatch;
+
+void SpriteBatch_Init(SpriteBatch *batch);
+void SpriteBatch_Begin(SpriteBatch *batch);
+bool SpriteBatch_Draw(SpriteBatch *batch, SDL_Texture *texture, const SDL_Rect *src, const SDL_Rect *dst,
+                      SDL_RendererFlip flip, int layer);
+void SpriteBatch_Flush(SpriteBatch *batch, SDL_Renderer *renderer);
+void SpriteBatch_Free(SpriteBatch *batch);
@@ -2,14 +2,50 @@
 
 #include <SDL.h>
 #include <SDL_image.h>
+#include <stdbool.h>
+#include <stddef.h>
 
-// Simple texture cache structure
-typedef struct {
-    char* path;
-    SDL_Texture* tex;
-} TextureCacheItem;
+typedef struct TextureCache TextureCache;
+typedef struct ImageDecoder ImageDecoder;
+
+// One cached image. Handles stay valid (same address) until their last reference
+// is released and the entry is evicted, so holders can keep `tex` around directly.
+typedef struct CachedTexture {
+    TextureCache *cache;
+    char *path;
+    Uint32 hash;
+    SDL_Texture *tex;
+    int w, h;
+    size_t bytes;
+    int refCount;
+    struct CachedTexture *prev, *next;  // LRU list of unreferenced entries, most recent at head
+} CachedTexture;
+
+// Path keyed texture cache owned by GameManager. Open addressing with linear
+// probing over handle pointers; unreferenced textures stay resident until the
+// byte budget needs their space.
+typedef struct TextureCache {
+    SDL_Renderer *renderer;
+    ImageDecoder *decoder;      // decodes misses in parallel, NULL decodes on the calling thread
+    SDL_mutex *lock;            // lookups may come from the level loader thread
+    CachedTexture **slots;
+    int capacity;               // power of two
+    int count;                  // live entries
+    int tombstones;
+    size_t bytesUsed;
+    size_t budgetBytes;
+    CachedTexture *lruHead;
+    CachedTexture *lruTail;
+} TextureCache;
 
 SDL_Texture* loadTexture(const char* filepath, SDL_Renderer* renderer);
-SDL_Texture *getTextureCached(SDL_Renderer *renderer, const char *path);
-void freeTexture(SDL_Texture *tex, SDL_Renderer *renderer);
-void freeAllTextures();
+
+TextureCache *TextureCache_Create(SDL_Renderer *renderer, ImageDecoder *decoder, size_t budgetBytes);
+void TextureCache_Destroy(TextureCache *cache);
+
+CachedTexture *TextureCache_Acquire(TextureCache *cache, const char *path);
+CachedTexture *TextureCache_AcquireLoaded(TextureCache *cache, const char *path);
+bool TextureCache_AcquireMany(TextureCache *cache, const char *const *paths, int count, CachedTexture **out);
+CachedTexture *TextureCache_Adopt(TextureCache *cache, const char *path, SDL_Texture *tex);
+bool TextureCache_Contains(TextureCache *cache, const char *path);
+void TextureCache_Release(CachedTexture *handle);
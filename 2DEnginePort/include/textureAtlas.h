@@ -0,0 +1,40 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+
+#define ATLAS_PADDING 2         // pixels kept free around every packed image or cell
+#define ATLAS_MIN_PAGE 256
+#define ATLAS_MAX_PAGE 4096     // clamped to the renderer's max texture size
+
+// One image to pack. With cellSize > 0 the image is a grid of cells (a tileset): every
+// cell is packed with its own border, filled by repeating the cell's edge pixels, so a
+// tile scaled up by TILE_SCALE never picks up its neighbour. With cellSize 0 the image
+// goes in whole behind a transparent border, for sprite sheets whose frames already
+// have empty margins.
+typedef struct AtlasItem {
+    SDL_Texture *source;
+    int w, h;               // source size in pixels
+    int cellSize;
+
+    // Filled in by TextureAtlas_Create
+    int page;               // -1 when it wasn't packed, keep drawing from source
+    int x, y;               // where the source's top left pixel (cell 0) ended up in the page
+    int stride;             // distance between cells in the page, cellSize + 2 * ATLAS_PADDING
+} AtlasItem;
+
+// Square render target pages, packed with a skyline (bottom left) packer. The pages
+// are drawn from the source textures on the GPU, so the sources have to stay alive
+// for TextureAtlas_Redraw after SDL_RENDER_TARGETS_RESET.
+typedef struct TextureAtlas {
+    SDL_Renderer *renderer;
+    SDL_Texture **pages;
+    int pageCount;
+    int pageSize;
+    AtlasItem *items;       // what was packed, for redrawing
+    int itemCount;
+} TextureAtlas;
+
+TextureAtlas *TextureAtlas_Create(SDL_Renderer *renderer, AtlasItem *items, int count);
+bool TextureAtlas_Redraw(TextureAtlas *atlas);
+void TextureAtlas_Destroy(TextureAtlas *atlas);
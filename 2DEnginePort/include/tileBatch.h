@@ -0,0 +1,23 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdbool.h>
+
+// Collects textured quads for one texture and submits them with a single
+// SDL_RenderGeometry call. Buffers only grow, so once they've reached the
+// size of a full screen of tiles, building a batch does no allocation.
+typedef struct TileBatch {
+    SDL_Vertex *vertices;   // 4 per quad
+    int *indices;           // 6 per quad, fixed pattern, built when the buffers grow
+    int quadCount;
+    int quadCapacity;
+} TileBatch;
+
+void TileBatch_Init(TileBatch *batch);
+bool TileBatch_Reserve(TileBatch *batch, int quadCount);
+void TileBatch_Clear(TileBatch *batch);
+void TileBatch_AddQuad(TileBatch *batch, const SDL_Rect *src, const SDL_Rect *dst, float invTexW, float invTexH);
+void TileBatch_AddQuadFlipped(TileBatch *batch, const SDL_Rect *src, const SDL_Rect *dst, float invTexW, float invTexH,
+                              SDL_RendererFlip flip);
+bool TileBatch_Flush(TileBatch *batch, SDL_Renderer *renderer, SDL_Texture *tex);
+void TileBatch_Free(TileBatch *batch);
@@ -1,5 +1,6 @@
 #define SDL_MAIN_HANDLED
 #include "gameManager.h"
+#include "profiler.h"
 
 #include <stdio.h>
 
@@ -11,21 +12,19 @@ int main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
-    float deltaTime;
-    Uint32 last_ticks = SDL_GetTicks();
-    Uint32 current_ticks;
-
     // Main game loop
     while (gm->running) {
-        current_ticks = SDL_GetTicks();
-        deltaTime = (current_ticks - last_ticks) / 1000.0f;
-        last_ticks = current_ticks;
+        float frameTime = FramePacer_BeginFrame(&gm->pacer);
+        PROFILE_FRAME_BEGIN();
 
         GameManager_HandleInput(gm);
-        GameManager_Update(gm, deltaTime);
+        GameManager_Update(gm, frameTime);
         GameManager_Render(gm);
 
-        SDL_Delay(15); // ~60 FPS cap
+        PROFILE_BEGIN("FramePacer wait");
+        FramePacer_EndFrame(&gm->pacer);
+        PROFILE_END();
+        PROFILE_FRAME_END();
     }
 
     GameManager_Destroy(gm, EXIT_SUCCESS);
@@ -0,0 +1,237 @@
+#include "aabbBatch.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define AABB_HAVE_SSE2 1
+#endif
+
+// AVX2 code is compiled on 64-bit x86 whatever the build flags, and only run when
+// the CPU has it. GCC and Clang need the target attribute for that, MSVC doesn't.
+#if defined(_M_X64) || (defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)))
+    #include <immintrin.h>
+    #define AABB_HAVE_AVX2 1
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define AABB_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+    #define AABB_TARGET_AVX2
+#endif
+
+typedef void (*AabbRectsKernel)(const SDL_Rect *query, const SDL_Rect *rects, int begin, int end, Uint32 *hits);
+typedef void (*AabbSoAKernel)(const SDL_FRect *query, const float *x, const float *y, const float *w,
+                              const float *h, int begin, int end, Uint32 *hits);
+
+typedef struct AabbBackend {
+    const char *name;
+    int width;                  // boxes per kernel step, the plain C tail does the rest
+    AabbRectsKernel rects;
+    AabbSoAKernel soa;
+} AabbBackend;
+
+static int AABB_PopCount(Uint32 v)
+{
+    v = v - ((v >> 1) & 0x55555555u);
+    v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+    return (int)((((v + (v >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+}
+
+// Plain C, also the tail of the vector kernels. Branch free so it doesn't
+// mispredict on crowds where half the boxes overlap.
+static void AABB_RectsScalar(const SDL_Rect *query, const SDL_Rect *rects, int begin, int end, Uint32 *hits)
+{
+    int qx2 = query->x + query->w;
+    int qy2 = query->y + query->h;
+    for (int i = begin; i < end; i++) {
+        const SDL_Rect *r = &rects[i];
+        Uint32 hit = (Uint32)((query->x < r->x + r->w) & (qx2 > r->x) & (query->y < r->y + r->h) & (qy2 > r->y));
+        hits[i >> 5] |= hit << (i & 31);
+    }
+}
+
+static void AABB_SoAScalar(const SDL_FRect *query, const float *x, const float *y, const float *w,
+                           const float *h, int begin, int end, Uint32 *hits)
+{
+    float qx2 = query->x + query->w;
+    float qy2 = query->y + query->h;
+    for (int i = begin; i < end; i++) {
+        Uint32 hit = (Uint32)((query->x < x[i] + w[i]) & (qx2 > x[i]) & (query->y < y[i] + h[i]) & (qy2 > y[i]));
+        hits[i >> 5] |= hit << (i & 31);
+    }
+}
+
+#ifdef AABB_HAVE_SSE2
+// Four SDL_Rects at a time, transposed from x,y,w,h per rect to one register per field
+static void AABB_RectsSSE2(const SDL_Rect *query, const SDL_Rect *rects, int begin, int end, Uint32 *hits)
+{
+    const __m128i qx = _mm_set1_epi32(query->x);
+    const __m128i qy = _mm_set1_epi32(query->y);
+    const __m128i qx2 = _mm_set1_epi32(query->x + query->w);
+    const __m128i qy2 = _mm_set1_epi32(query->y + query->h);
+
+    int i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128i r0 = _mm_loadu_si128((const __m128i *)&rects[i]);
+        __m128i r1 = _mm_loadu_si128((const __m128i *)&rects[i + 1]);
+        __m128i r2 = _mm_loadu_si128((const __m128i *)&rects[i + 2]);
+        __m128i r3 = _mm_loadu_si128((const __m128i *)&rects[i + 3]);
+
+        __m128i xy01 = _mm_unpacklo_epi32(r0, r1);
+        __m128i xy23 = _mm_unpacklo_epi32(r2, r3);
+        __m128i wh01 = _mm_unpackhi_epi32(r0, r1);
+        __m128i wh23 = _mm_unpackhi_epi32(r2, r3);
+        __m128i x = _mm_unpacklo_epi64(xy01, xy23);
+        __m128i y = _mm_unpackhi_epi64(xy01, xy23);
+        __m128i x2 = _mm_add_epi32(x, _mm_unpacklo_epi64(wh01, wh23));
+        __m128i y2 = _mm_add_epi32(y, _mm_unpackhi_epi64(wh01, wh23));
+
+        __m128i m = _mm_and_si128(_mm_cmpgt_epi32(x2, qx), _mm_cmpgt_epi32(qx2, x));
+        m = _mm_and_si128(m, _mm_and_si128(_mm_cmpgt_epi32(y2, qy), _mm_cmpgt_epi32(qy2, y)));
+        hits[i >> 5] |= (Uint32)_mm_movemask_ps(_mm_castsi128_ps(m)) << (i & 31);
+    }
+    AABB_RectsScalar(query, rects, i, end, hits);
+}
+
+static void AABB_SoASSE2(const SDL_FRect *query, const float *x, const float *y, const float *w,
+                         const float *h, int begin, int end, Uint32 *hits)
+{
+    const __m128 qx = _mm_set1_ps(query->x);
+    const __m128 qy = _mm_set1_ps(query->y);
+    const __m128 qx2 = _mm_set1_ps(query->x + query->w);
+    const __m128 qy2 = _mm_set1_ps(query->y + query->h);
+
+    int i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 bx = _mm_loadu_ps(&x[i]);
+        __m128 by = _mm_loadu_ps(&y[i]);
+        __m128 bx2 = _mm_add_ps(bx, _mm_loadu_ps(&w[i]));
+        __m128 by2 = _mm_add_ps(by, _mm_loadu_ps(&h[i]));
+
+        __m128 m = _mm_and_ps(_mm_cmplt_ps(qx, bx2), _mm_cmplt_ps(bx, qx2));
+        m = _mm_and_ps(m, _mm_and_ps(_mm_cmplt_ps(qy, by2), _mm_cmplt_ps(by, qy2)));
+        hits[i >> 5] |= (Uint32)_mm_movemask_ps(m) << (i & 31);
+    }
+    AABB_SoAScalar(query, x, y, w, h, i, end, hits);
+}
+#endif
+
+#ifdef AABB_HAVE_AVX2
+// Eight SDL_Rects at a time, two per 256-bit load. The in-lane unpacks leave the
+// rects in 0,2,4,6,1,3,5,7 order, one permute puts the result back in order.
+AABB_TARGET_AVX2
+static void AABB_RectsAVX2(const SDL_Rect *query, const SDL_Rect *rects, int begin, int end, Uint32 *hits)
+{
+    const __m256i qx = _mm256_set1_epi32(query->x);
+    const __m256i qy = _mm256_set1_epi32(query->y);
+    const __m256i qx2 = _mm256_set1_epi32(query->x + query->w);
+    const __m256i qy2 = _mm256_set1_epi32(query->y + query->h);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    int i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256i r01 = _mm256_loadu_si256((const __m256i *)&rects[i]);
+        __m256i r23 = _mm256_loadu_si256((const __m256i *)&rects[i + 2]);
+        __m256i r45 = _mm256_loadu_si256((const __m256i *)&rects[i + 4]);
+        __m256i r67 = _mm256_loadu_si256((const __m256i *)&rects[i + 6]);
+
+        __m256i xyA = _mm256_unpacklo_epi32(r01, r23);
+        __m256i xyB = _mm256_unpacklo_epi32(r45, r67);
+        __m256i whA = _mm256_unpackhi_epi32(r01, r23);
+        __m256i whB = _mm256_unpackhi_epi32(r45, r67);
+        __m256i x = _mm256_unpacklo_epi64(xyA, xyB);
+        __m256i y = _mm256_unpackhi_epi64(xyA, xyB);
+        __m256i x2 = _mm256_add_epi32(x, _mm256_unpacklo_epi64(whA, whB));
+        __m256i y2 = _mm256_add_epi32(y, _mm256_unpackhi_epi64(whA, whB));
+
+        __m256i m = _mm256_and_si256(_mm256_cmpgt_epi32(x2, qx), _mm256_cmpgt_epi32(qx2, x));
+        m = _mm256_and_si256(m, _mm256_and_si256(_mm256_cmpgt_epi32(y2, qy), _mm256_cmpgt_epi32(qy2, y)));
+        m = _mm256_permutevar8x32_epi32(m, order);
+        hits[i >> 5] |= (Uint32)_mm256_movemask_ps(_mm256_castsi256_ps(m)) << (i & 31);
+    }
+    AABB_RectsScalar(query, rects, i, end, hits);
+}
+
+AABB_TARGET_AVX2
+static void AABB_SoAAVX2(const SDL_FRect *query, const float *x, const float *y, const float *w,
+                         const float *h, int begin, int end, Uint32 *hits)
+{
+    const __m256 qx = _mm256_set1_ps(query->x);
+    const __m256 qy = _mm256_set1_ps(query->y);
+    const __m256 qx2 = _mm256_set1_ps(query->x + query->w);
+    const __m256 qy2 = _mm256_set1_ps(query->y + query->h);
+
+    int i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 bx = _mm256_loadu_ps(&x[i]);
+        __m256 by = _mm256_loadu_ps(&y[i]);
+        __m256 bx2 = _mm256_add_ps(bx, _mm256_loadu_ps(&w[i]));
+        __m256 by2 = _mm256_add_ps(by, _mm256_loadu_ps(&h[i]));
+
+        __m256 m = _mm256_and_ps(_mm256_cmp_ps(qx, bx2, _CMP_LT_OQ), _mm256_cmp_ps(bx, qx2, _CMP_LT_OQ));
+        m = _mm256_and_ps(m, _mm256_and_ps(_mm256_cmp_ps(qy, by2, _CMP_LT_OQ), _mm256_cmp_ps(by, qy2, _CMP_LT_OQ)));
+        hits[i >> 5] |= (Uint32)_mm256_movemask_ps(m) << (i & 31);
+    }
+    AABB_SoAScalar(query, x, y, w, h, i, end, hits);
+}
+#endif
+
+static const AabbBackend scalarBackend = { "scalar", 1, AABB_RectsScalar, AABB_SoAScalar };
+#ifdef AABB_HAVE_SSE2
+static const AabbBackend sse2Backend = { "SSE2", 4, AABB_RectsSSE2, AABB_SoASSE2 };
+#endif
+#ifdef AABB_HAVE_AVX2
+static const AabbBackend avx2Backend = { "AVX2", 8, AABB_RectsAVX2, AABB_SoAAVX2 };
+#endif
+
+// Picked once; threads racing on the first call all store the same pointer
+static const AabbBackend *AABB_GetBackend(void)
+{
+    static const AabbBackend *backend = NULL;
+    const AabbBackend *chosen = SDL_AtomicGetPtr((void **)&backend);
+    if (chosen) return chosen;
+
+    chosen = &scalarBackend;
+#ifdef AABB_HAVE_SSE2
+    if (SDL_HasSSE2()) chosen = &sse2Backend;
+#endif
+#ifdef AABB_HAVE_AVX2
+    if (SDL_HasAVX2()) chosen = &avx2Backend;
+#endif
+    SDL_AtomicSetPtr((void **)&backend, (void *)chosen);
+    return chosen;
+}
+
+static int AABB_CountHits(const Uint32 *hits, int count)
+{
+    int total = 0;
+    for (int i = 0; i < AABB_MASK_WORDS(count); i++) total += AABB_PopCount(hits[i]);
+    return total;
+}
+
+// AoS: SDL_Rects as they come, e.g. hurtboxes gathered from broadphase candidates
+int AABB_OverlapRects(const SDL_Rect *query, const SDL_Rect *rects, int count, Uint32 *hits)
+{
+    if (!query || !rects || !hits || count <= 0) return 0;
+
+    memset(hits, 0, AABB_MASK_WORDS(count) * sizeof(Uint32));
+    AABB_GetBackend()->rects(query, rects, 0, count, hits);
+    return AABB_CountHits(hits, count);
+}
+
+// SoA: separate coordinate arrays, such as the PhysicsWorld's x, y, w and h
+int AABB_OverlapSoA(const SDL_FRect *query, const float *x, const float *y, const float *w, const float *h,
+                    int count, Uint32 *hits)
+{
+    if (!query || !x || !y || !w || !h || !hits || count <= 0) return 0;
+
+    memset(hits, 0, AABB_MASK_WORDS(count) * sizeof(Uint32));
+    AABB_GetBackend()->soa(query, x, y, w, h, 0, count, hits);
+    return AABB_CountHits(hits, count);
+}
+
+const char *AABB_Backend(void)
+{
+    return AABB_GetBackend()->name;
+}
@@ -10,6 +10,8 @@ void Camera_Init(Camera *cam, int viewportW, int viewportH)
     if (!cam) return;
     cam->x = 0;
     cam->y = 0;
+    cam->prevX = 0;
+    cam->prevY = 0;
     cam->w = viewportW;
     cam->h = viewportH;
     cam->lookAheadX = 0;
@@ -23,9 +25,8 @@ void Camera_Update(Camera *cam, const Player *player, Level *lvl)
 {
     if (!cam || !player || !lvl) return;
 
-    int tileW = getLevelTileWidth(lvl);
-    int mapW = lvl->levelColumns * tileW;
-    int mapH = lvl->levelRows * tileW;
+    int mapW = lvl->pixelWidth;
+    int mapH = lvl->pixelHeight;
 
 
     int playerCenterX = player->body.x + player->body.collisionRect.w / 2;
@@ -71,3 +72,19 @@ SDL_Rect Camera_GetViewRect(const Camera *cam)
     rect.h = cam->h;
     return rect;
 }
+
+void Camera_StorePrevious(Camera *cam)
+{
+    if (!cam) return;
+    cam->prevX = cam->x;
+    cam->prevY = cam->y;
+}
+
+// Copy of the camera placed between its previous and current step, for drawing a frame
+Camera Camera_Interpolated(const Camera *cam, float alpha)
+{
+    Camera view = *cam;
+    view.x = (int)SDL_floorf(cam->prevX + (cam->x - cam->prevX) * alpha + 0.5f);
+    view.y = (int)SDL_floorf(cam->prevY + (cam->y - cam->prevY) * alpha + 0.5f);
+    return view;
+}
@@ -0,0 +1,250 @@
+#include "chunkCache.h"
+#include "level.h"
+#include "counters.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static LayerChunk *ChunkCache_Get(ChunkCache *cache, int layerIndex, int cx, int cy)
+{
+    return &cache->chunks[(layerIndex * cache->chunksY + cy) * cache->chunksX + cx];
+}
+
+static void ChunkCache_Unlink(ChunkCache *cache, LayerChunk *chunk)
+{
+    if (chunk->prev) chunk->prev->next = chunk->next;
+    else cache->lruHead = chunk->next;
+
+    if (chunk->next) chunk->next->prev = chunk->prev;
+    else cache->lruTail = chunk->prev;
+
+    chunk->prev = NULL;
+    chunk->next = NULL;
+}
+
+static void ChunkCache_PushFront(ChunkCache *cache, LayerChunk *chunk)
+{
+    chunk->prev = NULL;
+    chunk->next = cache->lruHead;
+    if (cache->lruHead) cache->lruHead->prev = chunk;
+    cache->lruHead = chunk;
+    if (!cache->lruTail) cache->lruTail = chunk;
+}
+
+static void ChunkCache_Evict(ChunkCache *cache, LayerChunk *chunk)
+{
+    ChunkCache_Unlink(cache, chunk);
+    SDL_DestroyTexture(chunk->tex);
+    chunk->tex = NULL;
+    cache->bytesUsed -= chunk->bytes;
+    chunk->bytes = 0;
+}
+
+// Drops least recently used chunks until `incoming` more bytes fit in the budget
+static void ChunkCache_MakeRoom(ChunkCache *cache, size_t incoming)
+{
+    while (cache->lruTail && cache->bytesUsed + incoming > cache->budgetBytes) {
+        ChunkCache_Evict(cache, cache->lruTail);
+    }
+}
+
+ChunkCache *ChunkCache_Create(Level *lvl, SDL_Renderer *renderer, size_t budgetBytes)
+{
+    if (!lvl || !renderer || lvl->layerCount <= 0) return NULL;
+
+    if (!SDL_RenderTargetSupported(renderer)) {
+        fprintf(stderr, "[ChunkCache] Render targets not supported, static layers will be drawn per tile\n");
+        return NULL;
+    }
+
+    ChunkCache *cache = calloc(1, sizeof(ChunkCache));
+    if (!cache) return NULL;
+
+    cache->layerCount = lvl->layerCount;
+    cache->chunksX = (lvl->levelColumns + CHUNK_TILES - 1) / CHUNK_TILES;
+    cache->chunksY = (lvl->levelRows + CHUNK_TILES - 1) / CHUNK_TILES;
+    cache->budgetBytes = budgetBytes;
+    cache->chunks = calloc((size_t)cache->layerCount * cache->chunksX * cache->chunksY, sizeof(LayerChunk));
+    if (!cache->chunks) {
+        free(cache);
+        return NULL;
+    }
+
+    return cache;
+}
+
+void ChunkCache_Destroy(ChunkCache *cache)
+{
+    if (!cache) return;
+    while (cache->lruHead) {
+        ChunkCache_Evict(cache, cache->lruHead);
+    }
+    free(cache->chunks);
+    free(cache);
+}
+
+// Scans the chunk's tiles once so fully empty chunks never get a texture
+static bool ChunkCache_IsEmpty(const Layer *layer, const Level *lvl, int col0, int row0, int cols, int rows)
+{
+    for (int r = 0; r < rows; r++) {
+        const int *rowTiles = &layer->tiles[(row0 + r) * lvl->levelColumns + col0];
+        for (int c = 0; c < cols; c++) {
+            if (rowTiles[c] >= 0) return false;
+        }
+    }
+    return true;
+}
+
+// Draws the chunk's tiles into its render target at source resolution
+static bool ChunkCache_Bake(ChunkCache *cache, LayerChunk *chunk, Level *lvl, Layer *layer, Tileset *ts,
+                            SDL_Renderer *renderer, int col0, int row0, int cols, int rows)
+{
+    int w = cols * ts->tileSize;
+    int h = rows * ts->tileSize;
+
+    if (!chunk->tex) {
+        size_t bytes = (size_t)w * h * 4;
+        ChunkCache_MakeRoom(cache, bytes);
+
+        chunk->tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+        if (!chunk->tex) {
+            fprintf(stderr, "[ChunkCache] Failed to create chunk texture: %s\n", SDL_GetError());
+            return false;
+        }
+        SDL_SetTextureBlendMode(chunk->tex, SDL_BLENDMODE_BLEND);
+        chunk->w = w;
+        chunk->h = h;
+        chunk->bytes = bytes;
+        cache->bytesUsed += bytes;
+        ChunkCache_PushFront(cache, chunk);
+    }
+
+    // Render scale would otherwise apply to the target too
+    SDL_Texture *prevTarget = SDL_GetRenderTarget(renderer);
+    float scaleX, scaleY;
+    SDL_RenderGetScale(renderer, &scaleX, &scaleY);
+    SDL_BlendMode prevDrawBlend;
+    SDL_GetRenderDrawBlendMode(renderer, &prevDrawBlend);
+
+    // Copy alpha as is instead of blending it onto the cleared chunk, the chunk
+    // itself is blended when drawn and would apply it twice
+    SDL_BlendMode sourceBlend;
+    SDL_GetTextureBlendMode(ts->tex, &sourceBlend);
+    SDL_SetTextureBlendMode(ts->tex, SDL_BLENDMODE_NONE);
+
+    SDL_SetRenderTarget(renderer, chunk->tex);
+    SDL_RenderSetScale(renderer, 1.0f, 1.0f);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    for (int r = 0; r < rows; r++) {
+        const int *rowTiles = &layer->tiles[(row0 + r) * lvl->levelColumns + col0];
+        for (int c = 0; c < cols; c++) {
+            int idx = rowTiles[c];
+            if (idx < 0) continue;
+
+            SDL_Rect src = Tileset_TileRect(ts, idx);
+            SDL_Rect dst = { c * ts->tileSize, r * ts->tileSize, ts->tileSize, ts->tileSize };
+            SDL_RenderCopy(renderer, ts->tex, &src, &dst);
+            COUNTER_DRAW(ts->tex);
+        }
+    }
+
+    SDL_SetTextureBlendMode(ts->tex, sourceBlend);
+    SDL_SetRenderTarget(renderer, prevTarget);
+    SDL_RenderSetScale(renderer, scaleX, scaleY);
+    SDL_SetRenderDrawBlendMode(renderer, prevDrawBlend);
+
+    chunk->dirty = false;
+    return true;
+}
+
+// Draws one textured quad per visible chunk of a static layer, baking chunks on first use
+void ChunkCache_RenderLayer(ChunkCache *cache, Level *lvl, int layerIndex, SDL_Renderer *renderer, const SDL_Rect *view)
+{
+    if (!cache || !lvl || layerIndex < 0 || layerIndex >= cache->layerCount) return;
+
+    Layer *layer = &lvl->layers[layerIndex];
+    if (!layer->tiles) return;
+
+    Tileset *ts = level_getLayerTileset(lvl, layer);
+    if (!ts || !ts->tex) return;
+
+    int scaledTile = layer->scaledTileSize;
+    int chunkPixels = CHUNK_TILES * scaledTile;
+    if (chunkPixels <= 0) return;
+
+    int cx0 = view->x / chunkPixels;
+    int cy0 = view->y / chunkPixels;
+    int cx1 = (view->x + view->w) / chunkPixels;
+    int cy1 = (view->y + view->h) / chunkPixels;
+
+    if (cx0 < 0) cx0 = 0;
+    if (cy0 < 0) cy0 = 0;
+    if (cx1 >= cache->chunksX) cx1 = cache->chunksX - 1;
+    if (cy1 >= cache->chunksY) cy1 = cache->chunksY - 1;
+
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            LayerChunk *chunk = ChunkCache_Get(cache, layerIndex, cx, cy);
+
+            int col0 = cx * CHUNK_TILES;
+            int row0 = cy * CHUNK_TILES;
+            int cols = SDL_min(CHUNK_TILES, lvl->levelColumns - col0);
+            int rows = SDL_min(CHUNK_TILES, lvl->levelRows - row0);
+
+            if (!chunk->known || chunk->dirty) {
+                chunk->empty = ChunkCache_IsEmpty(layer, lvl, col0, row0, cols, rows);
+                chunk->known = true;
+            }
+            if (chunk->empty) {
+                // An edit may have emptied a resident chunk
+                if (chunk->tex) ChunkCache_Evict(cache, chunk);
+                chunk->dirty = false;
+                continue;
+            }
+
+            bool resident = chunk->tex != NULL;
+            if (!resident || chunk->dirty) {
+                if (!ChunkCache_Bake(cache, chunk, lvl, layer, ts, renderer, col0, row0, cols, rows)) continue;
+            }
+            if (resident) {
+                ChunkCache_Unlink(cache, chunk);
+                ChunkCache_PushFront(cache, chunk);
+            }
+
+            SDL_Rect dst = {
+                col0 * scaledTile - view->x,
+                row0 * scaledTile - view->y,
+                cols * scaledTile,
+                rows * scaledTile
+            };
+            SDL_RenderCopy(renderer, chunk->tex, NULL, &dst);
+            COUNTER_DRAW(chunk->tex);
+        }
+    }
+}
+
+// Only the chunk containing the tile is rebaked, the rest stay as they are
+void ChunkCache_InvalidateTile(ChunkCache *cache, int layerIndex, int col, int row)
+{
+    if (!cache || layerIndex < 0 || layerIndex >= cache->layerCount || col < 0 || row < 0) return;
+
+    int cx = col / CHUNK_TILES;
+    int cy = row / CHUNK_TILES;
+    if (cx >= cache->chunksX || cy >= cache->chunksY) return;
+
+    ChunkCache_Get(cache, layerIndex, cx, cy)->dirty = true;
+}
+
+// Render target contents are lost on device/target resets, everything has to be rebaked
+void ChunkCache_InvalidateAll(ChunkCache *cache)
+{
+    if (!cache) return;
+    int total = cache->layerCount * cache->chunksX * cache->chunksY;
+    for (int i = 0; i < total; i++) {
+        cache->chunks[i].dirty = true;
+    }
+}
@@ -1,6 +1,9 @@
 #include "collision.h"
 #include "level.h"
 #include "player.h"
+#include "counters.h"
+
+#include <math.h>
 
 bool isSolidTile(Level *lvl, int tileIndex) {
     // Loop through all layers and see if any are collidable
@@ -49,58 +52,54 @@ bool collisionCheck(SDL_Rect A, SDL_Rect B) {
 void checkEntityTileCollisionsX(PhysicsBody *body, Level *lvl, float deltaTime) {
     if (!body || !lvl) return;
 
+    int tileW = lvl->tileSize;
+    if (tileW <= 0) return;
+    int tileH = tileW; // Assuming square
+
     int left   = body->x;
     int right  = body->x + body->collisionRect.w - 1;
     int top    = body->y;
     int bottom = body->y + body->collisionRect.h - 1;
 
-    for (int layerIndex = 0; layerIndex < lvl->layerCount; layerIndex++) {
-        Layer *layer = &lvl->layers[layerIndex];
-        if (!layer->collidable) continue;
+    int leftTile   = left   / tileW;
+    int rightTile  = right  / tileW;
+    int topTile    = top    / tileH;
+    int bottomTile = bottom / tileH;
+
+    // Clamp
+    if (leftTile < 0) leftTile = 0;
+    if (rightTile >= lvl->levelColumns) rightTile = lvl->levelColumns - 1;
+    if (topTile < 0) topTile = 0;
+    if (bottomTile >= lvl->levelRows) bottomTile = lvl->levelRows - 1;
 
-        Tileset *ts = findTileset(lvl, layer->tileset_id);
-        if (!ts) continue;
-
-        int tileW = (int)(ts->tileSize * ts->scale);
-        int tileH = tileW; // Assuming square
-
-        int leftTile   = left   / tileW;
-        int rightTile  = right  / tileW;
-        int topTile    = top    / tileH;
-        int bottomTile = bottom / tileH;
-
-        // Clamp
-        if (leftTile < 0) leftTile = 0;
-        if (rightTile >= lvl->levelColumns) rightTile = lvl->levelColumns - 1;
-        if (topTile < 0) topTile = 0;
-        if (bottomTile >= lvl->levelRows) bottomTile = lvl->levelRows - 1;
-
-        for (int row = topTile; row <= bottomTile; row++) {
-            for (int col = leftTile; col <= rightTile; col++) {
-                int tileIndex = layer->tiles[row * lvl->levelColumns + col];
-                if (!isSolidTileInLayer(layer, tileIndex)) continue;
-
-                SDL_Rect tileRect = { col * tileW, row * tileH, tileW, tileH };
-
-                // Current/future rect using just updated body position
-                // Yes I know I dont need this, I ran into errors when using it as its supposed to
-                SDL_Rect futureRect = {
-                    (int)body->x ,
-                    (int)body->y,
-                    body->collisionRect.w,
-                    body->collisionRect.h
-                };
-
-                if (collisionCheck(futureRect, tileRect)) {
-                    if (body->velocity_x > 0) {
-                        // Moving right: stick to left edge of tile
-                        body->x = tileRect.x - body->collisionRect.w;
-                    } else if (body->velocity_x < 0) {
-                        // Moving left: stick to right edge of tile
-                        body->x = tileRect.x + tileRect.w;
-                    }
-                    body->velocity_x = 0;
+    if (rightTile >= leftTile && bottomTile >= topTile) {
+        COUNTER_ADD(COUNTER_COLLISION_PROBES, (rightTile - leftTile + 1) * (bottomTile - topTile + 1));
+    }
+
+    for (int row = topTile; row <= bottomTile; row++) {
+        for (int col = leftTile; col <= rightTile; col++) {
+            if (!level_isCellSolid(lvl, col, row)) continue;
+
+            SDL_Rect tileRect = { col * tileW, row * tileH, tileW, tileH };
+
+            // Current/future rect using just updated body position
+            // Yes I know I dont need this, I ran into errors when using it as its supposed to
+            SDL_Rect futureRect = {
+                (int)body->x ,
+                (int)body->y,
+                body->collisionRect.w,
+                body->collisionRect.h
+            };
+
+            if (collisionCheck(futureRect, tileRect)) {
+                if (body->velocity_x > 0) {
+                    // Moving right: stick to left edge of tile
+                    body->x = tileRect.x - body->collisionRect.w;
+                } else if (body->velocity_x < 0) {
+                    // Moving left: stick to right edge of tile
+                    body->x = tileRect.x + tileRect.w;
                 }
+                body->velocity_x = 0;
             }
         }
     }
@@ -111,51 +110,47 @@ void checkEntityTileCollisionsY(PhysicsBody *body, Level *lvl, float deltaTime)
 {
     if (!body || !lvl) return;
 
+    int tileW = lvl->tileSize;
+    if (tileW <= 0) return;
+    int tileH = tileW;
+
     int left   = (int)body->x;
     int right  = (int)(body->x + body->collisionRect.w);
     int top    = (int)body->y;
     int bottom = (int)(body->y + body->collisionRect.h);
 
-    for (int layerIndex = 0; layerIndex < lvl->layerCount; layerIndex++) {
-        Layer *layer = &lvl->layers[layerIndex];
-        if (!layer->collidable) continue;
-
-        Tileset *ts = findTileset(lvl, layer->tileset_id);
-        if (!ts) continue;
-
-        int tileW = (int)(ts->tileSize * ts->scale);
-        int tileH = tileW;
+    int leftTile   = left / tileW;
+    int rightTile  = right / tileW;
+    int topTile    = top / tileH;
+    int bottomTile = bottom / tileH;
 
-        int leftTile   = left / tileW;
-        int rightTile  = right / tileW;
-        int topTile    = top / tileH;
-        int bottomTile = bottom / tileH;
+    if (leftTile < 0) leftTile = 0;
+    if (rightTile >= lvl->levelColumns) rightTile = lvl->levelColumns - 1;
+    if (topTile < 0) topTile = 0;
+    if (bottomTile >= lvl->levelRows) bottomTile = lvl->levelRows - 1;
 
-        if (leftTile < 0) leftTile = 0;
-        if (rightTile >= lvl->levelColumns) rightTile = lvl->levelColumns - 1;
-        if (topTile < 0) topTile = 0;
-        if (bottomTile >= lvl->levelRows) bottomTile = lvl->levelRows - 1;
-
-        for (int row = topTile; row <= bottomTile; row++) {
-            for (int col = leftTile; col <= rightTile; col++) {
-                int tileIndex = layer->tiles[row * lvl->levelColumns + col];
-                if (!isSolidTileInLayer(layer, tileIndex)) continue;
+    if (rightTile >= leftTile && bottomTile >= topTile) {
+        COUNTER_ADD(COUNTER_COLLISION_PROBES, (rightTile - leftTile + 1) * (bottomTile - topTile + 1));
+    }
 
-                SDL_Rect tileRect = { col * tileW, row * tileH, tileW, tileH };
+    for (int row = topTile; row <= bottomTile; row++) {
+        for (int col = leftTile; col <= rightTile; col++) {
+            if (!level_isCellSolid(lvl, col, row)) continue;
 
-                SDL_Rect futureRect = { (int)body->x, (int)body->y, body->collisionRect.w, body->collisionRect.h };
-                if (collisionCheck(futureRect, tileRect)) {
+            SDL_Rect tileRect = { col * tileW, row * tileH, tileW, tileH };
 
-                    if (body->velocity_y > 0) { // Falling
-                        body->y = tileRect.y - body->collisionRect.h;
-                        body->velocity_y = 0;
-                        body->isOnGround = true;
-                    } else if (body->velocity_y < 0) { // Rising / hitting ceiling
-                        body->y = tileRect.y + tileRect.h;
-                        body->velocity_y = 0;
-                    }
+            SDL_Rect futureRect = { (int)body->x, (int)body->y, body->collisionRect.w, body->collisionRect.h };
+            if (collisionCheck(futureRect, tileRect)) {
 
+                if (body->velocity_y > 0) { // Falling
+                    body->y = tileRect.y - body->collisionRect.h;
+                    body->velocity_y = 0;
+                    body->isOnGround = true;
+                } else if (body->velocity_y < 0) { // Rising / hitting ceiling
+                    body->y = tileRect.y + tileRect.h;
+                    body->velocity_y = 0;
                 }
+
             }
         }
     }
@@ -164,51 +159,213 @@ void checkEntityTileCollisionsY(PhysicsBody *body, Level *lvl, float deltaTime)
 bool hasCeilingAbove(const PhysicsBody *body, Level *lvl, int extraHeight) {
     if (!body || !lvl) return false;
 
+    int tileW = lvl->tileSize;
+    if (tileW <= 0) return false;
+    int tileH = tileW;
+
     int left   = (int)body->x;
     int right  = (int)(body->x + body->collisionRect.w - 1);
     int top    = (int)(body->y - extraHeight); // extend upward
     int bottom = (int)body->y; // current top of body
 
-    for (int layerIndex = 0; layerIndex < lvl->layerCount; layerIndex++) {
-        Layer *layer = &lvl->layers[layerIndex];
-        if (!layer->collidable) continue;
+    int leftTile   = left / tileW;
+    int rightTile  = right / tileW;
+    int topTile    = top / tileH;
+    int bottomTile = bottom / tileH;
+
+    if (leftTile < 0) leftTile = 0;
+    if (rightTile >= lvl->levelColumns) rightTile = lvl->levelColumns - 1;
+    if (topTile < 0) topTile = 0;
+    if (bottomTile >= lvl->levelRows) bottomTile = lvl->levelRows - 1;
+
+    SDL_Rect futureRect = {
+        (int)body->x,
+        (int)(body->y - extraHeight), // simulate taller body
+        body->collisionRect.w,
+        body->collisionRect.h + extraHeight
+    };
+
+    for (int row = topTile; row <= bottomTile; row++) {
+        for (int col = leftTile; col <= rightTile; col++) {
+            if (!level_isCellSolid(lvl, col, row)) continue;
+
+            SDL_Rect tileRect = { col * tileW, row * tileH, tileW, tileH };
+            if (collisionCheck(futureRect, tileRect)) {
+                return true; // there is a ceiling in the way
+            }
+        }
+    }
+
+    return false;
+}
+
+static void PhysicsBody_ClearHit(SweepHit *hit)
+{
+    hit->hit = false;
+    hit->time = 1.0f;
+    hit->normalX = hit->normalY = 0.0f;
+    hit->col = hit->row = -1;
+}
+
+// Sweeps a box along one axis: `pos`/`size` is its extent on that axis, [spanMin, spanMax)
+// its extent on the other one. Walks the cell columns (or rows) the leading edge
+// crosses, nearest first, so the first solid cell found is the contact however far
+// the box moves in one step. Cells the box already overlaps are ignored, which lets
+// a body that ended up inside a tile move out of it. Cells tested are added to *probes.
+static bool PhysicsBody_SweepAxis(const Level *lvl, bool vertical, float pos, float size,
+                                  float spanMin, float spanMax, float delta, SweepHit *hit, int *probes)
+{
+    PhysicsBody_ClearHit(hit);
+
+    int tile = lvl ? lvl->tileSize : 0;
+    if (tile <= 0 || delta == 0.0f) return false;
+
+    int lines = vertical ? lvl->levelRows : lvl->levelColumns;
+    int spanCount = vertical ? lvl->levelColumns : lvl->levelRows;
+
+    // Cells on the other axis that the box overlaps
+    int first = (int)floorf(spanMin / tile);
+    int last = (int)ceilf(spanMax / tile) - 1;
+    if (first < 0) first = 0;
+    if (last >= spanCount) last = spanCount - 1;
+    if (last < first) return false;
+
+    // Lines (columns or rows) the leading edge enters, from nearest to furthest
+    int start, end, step;
+    if (delta > 0.0f) {
+        float edge = pos + size;
+        start = (int)ceilf(edge / tile);
+        end = (int)ceilf((edge + delta) / tile) - 1;
+        step = 1;
+        if (start < 0) start = 0;
+        if (end >= lines) end = lines - 1;
+        if (start > end) return false;
+    } else {
+        start = (int)floorf(pos / tile) - 1;
+        end = (int)floorf((pos + delta) / tile);
+        step = -1;
+        if (start >= lines) start = lines - 1;
+        if (end < 0) end = 0;
+        if (start < end) return false;
+    }
 
-        Tileset *ts = findTileset(lvl, layer->tileset_id);
-        if (!ts) continue;
+    for (int line = start; line != end + step; line += step) {
+        for (int span = first; span <= last; span++) {
+            int col = vertical ? span : line;
+            int row = vertical ? line : span;
+            (*probes)++;
+            if (!level_isCellSolid(lvl, col, row)) continue;
+
+            float distance = delta > 0.0f ? (float)line * tile - (pos + size)
+                                          : pos - (float)(line + 1) * tile;
+            hit->hit = true;
+            hit->time = SDL_clamp(distance / fabsf(delta), 0.0f, 1.0f);
+            hit->col = col;
+            hit->row = row;
+            if (vertical) hit->normalY = delta > 0.0f ? -1.0f : 1.0f;
+            else hit->normalX = delta > 0.0f ? -1.0f : 1.0f;
+            return true;
+        }
+    }
+    return false;
+}
 
-        int tileW = (int)(ts->tileSize * ts->scale);
-        int tileH = tileW;
+// Time of impact of moving the body dx pixels horizontally through the tile grid
+bool PhysicsBody_SweepX(const PhysicsBody *body, const Level *lvl, float dx, SweepHit *hit)
+{
+    SweepHit unused;
+    if (!hit) hit = &unused;
+    if (!body) {
+        PhysicsBody_ClearHit(hit);
+        return false;
+    }
 
-        int leftTile   = left / tileW;
-        int rightTile  = right / tileW;
-        int topTile    = top / tileH;
-        int bottomTile = bottom / tileH;
+    int probes = 0;
+    bool hitSomething = PhysicsBody_SweepAxis(lvl, false, body->x, (float)body->collisionRect.w,
+                                              body->y, body->y + body->collisionRect.h, dx, hit, &probes);
+    COUNTER_ADD(COUNTER_COLLISION_PROBES, probes);
+    return hitSomething;
+}
 
-        if (leftTile < 0) leftTile = 0;
-        if (rightTile >= lvl->levelColumns) rightTile = lvl->levelColumns - 1;
-        if (topTile < 0) topTile = 0;
-        if (bottomTile >= lvl->levelRows) bottomTile = lvl->levelRows - 1;
+// Time of impact of moving the body dy pixels vertically through the tile grid
+bool PhysicsBody_SweepY(const PhysicsBody *body, const Level *lvl, float dy, SweepHit *hit)
+{
+    SweepHit unused;
+    if (!hit) hit = &unused;
+    if (!body) {
+        PhysicsBody_ClearHit(hit);
+        return false;
+    }
 
-        for (int row = topTile; row <= bottomTile; row++) {
-            for (int col = leftTile; col <= rightTile; col++) {
-                int tileIndex = layer->tiles[row * lvl->levelColumns + col];
-                if (!isSolidTileInLayer(layer, tileIndex)) continue;
+    int probes = 0;
+    bool hitSomething = PhysicsBody_SweepAxis(lvl, true, body->y, (float)body->collisionRect.h,
+                                              body->x, body->x + body->collisionRect.w, dy, hit, &probes);
+    COUNTER_ADD(COUNTER_COLLISION_PROBES, probes);
+    return hitSomething;
+}
 
-                SDL_Rect tileRect = { col * tileW, row * tileH, tileW, tileH };
+// Moves a w x h box at (*x, *y) by its velocity, horizontal first, then vertical,
+// stopping flush against the first solid tile on each axis and zeroing that part of
+// the velocity. Unlike moving and then testing the overlap, nothing tunnels through
+// thin floors at high speed or on long steps. Works on bare floats so the physics
+// world can run it on its arrays; cells tested are added to *probes.
+void moveBoxThroughTiles(const Level *lvl, float *x, float *y, float w, float h, float *vx, float *vy,
+                         float deltaTime, SweepHit *hitX, SweepHit *hitY, int *probes)
+{
+    int tile = lvl ? lvl->tileSize : 0;
+
+    float dx = *vx * deltaTime;
+    if (PhysicsBody_SweepAxis(lvl, false, *x, w, *y, *y + h, dx, hitX, probes)) {
+        // Snap to the tile edge rather than adding dx * time, so rounding never leaves
+        // the box a hair inside the wall or a gap away from it
+        *x = hitX->normalX < 0.0f ? (float)(hitX->col * tile) - w : (float)((hitX->col + 1) * tile);
+        *vx = 0.0f;
+    } else {
+        *x += dx;
+    }
 
-                SDL_Rect futureRect = {
-                    (int)body->x,
-                    (int)(body->y - extraHeight), // simulate taller body
-                    body->collisionRect.w,
-                    body->collisionRect.h + extraHeight
-                };
+    float dy = *vy * deltaTime;
+    if (PhysicsBody_SweepAxis(lvl, true, *y, h, *x, *x + w, dy, hitY, probes)) {
+        *y = hitY->normalY < 0.0f ? (float)(hitY->row * tile) - h : (float)((hitY->row + 1) * tile);
+        *vy = 0.0f;
+    } else {
+        *y += dy;
+    }
+}
 
-                if (collisionCheck(futureRect, tileRect)) {
-                    return true; // there is a ceiling in the way
-                }
-            }
-        }
+// Moves a body by its velocity through the tile grid, see moveBoxThroughTiles.
+// Landing sets isOnGround. hitX and hitY, both optional, receive the contact of each axis.
+void PhysicsBody_Move(PhysicsBody *body, const Level *lvl, float deltaTime, SweepHit *hitX, SweepHit *hitY)
+{
+    SweepHit sx, sy;
+    if (!hitX) hitX = &sx;
+    if (!hitY) hitY = &sy;
+    if (!body || !lvl) {
+        PhysicsBody_ClearHit(hitX);
+        PhysicsBody_ClearHit(hitY);
+        return;
     }
 
-    return false;
+    int probes = 0;
+    moveBoxThroughTiles(lvl, &body->x, &body->y, (float)body->collisionRect.w, (float)body->collisionRect.h,
+                        &body->velocity_x, &body->velocity_y, deltaTime, hitX, hitY, &probes);
+    if (hitY->hit && hitY->normalY < 0.0f) body->isOnGround = true;
+    COUNTER_ADD(COUNTER_COLLISION_PROBES, probes);
+}
+
+// Call before every simulation step, and after teleporting a body so it isn't
+// drawn sliding in from its old position
+void PhysicsBody_StorePrevious(PhysicsBody *body)
+{
+    if (!body) return;
+    body->prevX = body->x;
+    body->prevY = body->y;
+}
+
+// Where the body is drawn relative to its simulated position. alpha is how far the
+// frame is between the previous step (0) and the current one (1).
+void PhysicsBody_RenderOffset(const PhysicsBody *body, float alpha, float *dx, float *dy)
+{
+    *dx = (body->prevX - body->x) * (1.0f - alpha);
+    *dy = (body->prevY - body->y) * (1.0f - alpha);
 }
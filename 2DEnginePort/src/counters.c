@@ -0,0 +1,168 @@
+#include "counters.h"
+
+#include <string.h>
+
+typedef struct Counter {
+    const char *name;               // not copied, pass string literals
+    Uint64 value;                   // current frame, main thread only
+    Uint64 pending;                 // added by other threads, under Counters::lock
+    Uint64 total;
+    Uint64 history[COUNTERS_HISTORY];
+} Counter;
+
+typedef struct Counters {
+    bool initialized;
+    SDL_threadID thread;
+    Counter counters[COUNTERS_MAX];
+    int count;
+    SDL_SpinLock lock;
+    int historyIndex;               // next history slot
+    int historyCount;
+    SDL_Texture *lastTexture;       // for COUNTER_TEXTURE_SWITCHES
+} Counters;
+
+static Counters counters;
+
+static const char *builtinNames[COUNTER_BUILTIN_COUNT] = {
+    "Draw calls",
+    "Texture switches",
+    "Tiles visited",
+    "Tiles drawn",
+    "Collision probes",
+    "Bytes read",
+    "Images decoded",
+    "Physics bodies",
+    "Ray cells",
+};
+
+void Counters_Init(void)
+{
+    memset(&counters, 0, sizeof(Counters));
+    counters.thread = SDL_ThreadID();
+    for (int i = 0; i < COUNTER_BUILTIN_COUNT; i++) {
+        counters.counters[i].name = builtinNames[i];
+    }
+    counters.count = COUNTER_BUILTIN_COUNT;
+    counters.initialized = true;
+}
+
+// Returns the id of the counter called `name`, adding it if it's new. -1 when the
+// registry is full. Register from the main thread, before counting starts.
+int Counters_Register(const char *name)
+{
+    if (!name) return -1;
+
+    int id = Counters_Find(name);
+    if (id >= 0) return id;
+    if (counters.count == COUNTERS_MAX) return -1;
+
+    counters.counters[counters.count].name = name;
+    return counters.count++;
+}
+
+int Counters_Find(const char *name)
+{
+    for (int i = 0; name && i < counters.count; i++) {
+        if (strcmp(counters.counters[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+int Counters_Count(void)
+{
+    return counters.count;
+}
+
+const char *Counters_Name(int id)
+{
+    return id >= 0 && id < counters.count ? counters.counters[id].name : NULL;
+}
+
+void Counters_Add(int id, Uint64 amount)
+{
+    if (!counters.initialized || id < 0 || id >= counters.count) return;
+
+    Counter *counter = &counters.counters[id];
+    if (SDL_ThreadID() == counters.thread) {
+        counter->value += amount;
+        return;
+    }
+
+    SDL_AtomicLock(&counters.lock);
+    counter->pending += amount;
+    SDL_AtomicUnlock(&counters.lock);
+}
+
+// One draw call with `texture`, and a texture switch if the previous draw used another one
+void Counters_CountDraw(SDL_Texture *texture)
+{
+    if (!counters.initialized) return;
+
+    counters.counters[COUNTER_DRAW_CALLS].value++;
+    if (texture != counters.lastTexture) {
+        counters.counters[COUNTER_TEXTURE_SWITCHES].value++;
+        counters.lastTexture = texture;
+    }
+}
+
+// What other threads added since the last fold goes into the current value
+static void Counters_FoldPending(void)
+{
+    SDL_AtomicLock(&counters.lock);
+    for (int i = 0; i < counters.count; i++) {
+        counters.counters[i].value += counters.counters[i].pending;
+        counters.counters[i].pending = 0;
+    }
+    SDL_AtomicUnlock(&counters.lock);
+}
+
+// Whatever was counted before the first frame (startup) only shows up in the totals
+void Counters_BeginFrame(void)
+{
+    if (!counters.initialized) return;
+
+    Counters_FoldPending();
+    for (int i = 0; i < counters.count; i++) {
+        counters.counters[i].total += counters.counters[i].value;
+        counters.counters[i].value = 0;
+    }
+    counters.lastTexture = NULL;
+}
+
+void Counters_EndFrame(void)
+{
+    if (!counters.initialized) return;
+
+    Counters_FoldPending();
+    for (int i = 0; i < counters.count; i++) {
+        Counter *counter = &counters.counters[i];
+        counter->history[counters.historyIndex] = counter->value;
+        counter->total += counter->value;
+        counter->value = 0;
+    }
+    counters.historyIndex = (counters.historyIndex + 1) % COUNTERS_HISTORY;
+    if (counters.historyCount < COUNTERS_HISTORY) counters.historyCount++;
+}
+
+// Statistics over the frames in the history
+void Counters_GetStats(int id, CounterStats *stats)
+{
+    memset(stats, 0, sizeof(CounterStats));
+    if (id < 0 || id >= counters.count) return;
+
+    const Counter *counter = &counters.counters[id];
+    stats->total = counter->total;
+    stats->samples = counters.historyCount;
+    if (counters.historyCount == 0) return;
+
+    Uint64 sum = 0;
+    stats->min = ~(Uint64)0;
+    for (int i = 0; i < counters.historyCount; i++) {
+        Uint64 value = counter->history[i];
+        sum += value;
+        if (value < stats->min) stats->min = value;
+        if (value > stats->max) stats->max = value;
+    }
+    stats->avg = (double)sum / counters.historyCount;
+    stats->last = counter->history[(counters.historyIndex + COUNTERS_HISTORY - 1) % COUNTERS_HISTORY];
+}
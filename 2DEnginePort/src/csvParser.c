@@ -0,0 +1,294 @@
+#include "csvParser.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CSV_HAVE_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+#define CSV_BLOCK_SIZE (256 * 1024)
+
+// Parser state that survives block boundaries
+typedef struct {
+    int rows, cols;
+    int *out;
+
+    int row;                // current row (0-based)
+    int col;                // fields emitted in the current row
+    unsigned int value;     // magnitude accumulated so far
+    int digits;
+    bool negative;
+    bool inToken;           // saw a sign or digit
+    bool afterSpace;        // whitespace after digits, only a delimiter may follow
+    bool emptyField;        // saw "," with nothing before it, fine only if the line ends next
+    bool pendingCR;         // saw '\r', only the '\n' of a CRLF may follow
+
+    CsvResult result;
+} CsvParser;
+
+static inline int CSV_Ctz(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return (int)idx;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+static bool CSV_Fail(CsvParser *p, CsvStatus status)
+{
+    p->result.status = status;
+    p->result.row = p->row + 1;
+    p->result.column = p->col + 1;
+    return false;
+}
+
+static bool CSV_EmitField(CsvParser *p)
+{
+    if (!p->inToken) {
+        // ",," or a sign with no digits
+        return CSV_Fail(p, CSV_ERR_EMPTY_FIELD);
+    }
+    if (p->digits == 0) return CSV_Fail(p, CSV_ERR_BAD_CHAR);
+    if (p->emptyField) return CSV_Fail(p, CSV_ERR_EMPTY_FIELD);
+    if (p->row >= p->rows) return CSV_Fail(p, CSV_ERR_TOO_MANY_ROWS);
+    if (p->col >= p->cols) return CSV_Fail(p, CSV_ERR_TOO_MANY_COLUMNS);
+
+    int v = p->negative ? -(int)(p->value - 1) - 1 : (int)p->value;
+    p->out[(size_t)p->row * p->cols + p->col] = v;
+    p->col++;
+
+    p->value = 0;
+    p->digits = 0;
+    p->negative = false;
+    p->inToken = false;
+    p->afterSpace = false;
+    return true;
+}
+
+static bool CSV_Comma(CsvParser *p)
+{
+    if (!p->inToken) {
+        if (p->emptyField) return CSV_Fail(p, CSV_ERR_EMPTY_FIELD);
+        if (p->col == 0) return CSV_Fail(p, CSV_ERR_EMPTY_FIELD);   // line starts with ","
+        p->emptyField = true;
+        return true;
+    }
+    return CSV_EmitField(p);
+}
+
+static bool CSV_EndLine(CsvParser *p)
+{
+    if (p->inToken && !CSV_EmitField(p)) return false;
+
+    p->emptyField = false;
+    if (p->col == 0) return true;   // blank line
+
+    if (p->col < p->cols) return CSV_Fail(p, CSV_ERR_TOO_FEW_COLUMNS);
+    p->row++;
+    p->col = 0;
+    p->result.rowsRead = p->row;
+    return true;
+}
+
+// Everything between two delimiters goes through here. It's almost always 1-3 digits.
+static bool CSV_TokenBytes(CsvParser *p, const unsigned char *s, size_t n)
+{
+    if (p->pendingCR) return CSV_Fail(p, CSV_ERR_BAD_CHAR);   // lone '\r'
+
+    for (size_t i = 0; i < n; i++) {
+        unsigned int d = (unsigned int)s[i] - '0';
+        if (d < 10 && !p->afterSpace) {
+            if (p->digits >= 10) {
+                // only 10 digit values can overflow, anything longer always does
+                return CSV_Fail(p, CSV_ERR_OVERFLOW);
+            }
+            unsigned int limit = p->negative ? (unsigned int)INT_MAX + 1u : (unsigned int)INT_MAX;
+            if (p->value > (limit - d) / 10) return CSV_Fail(p, CSV_ERR_OVERFLOW);
+            p->value = p->value * 10 + d;
+            p->digits++;
+            p->inToken = true;
+        }
+        else if (s[i] == '-' && !p->inToken) {
+            p->negative = true;
+            p->inToken = true;
+        }
+        else if (s[i] == '+' && !p->inToken) {
+            p->inToken = true;
+        }
+        else if (s[i] == ' ' || s[i] == '\t') {
+            if (p->inToken) p->afterSpace = true;
+        }
+        else {
+            return CSV_Fail(p, CSV_ERR_BAD_CHAR);
+        }
+    }
+    return true;
+}
+
+static bool CSV_Delimiter(CsvParser *p, unsigned char c)
+{
+    if (p->pendingCR) {
+        // Anything but the '\n' of a CRLF would merge "12\r3" into 123
+        if (c != '\n') return CSV_Fail(p, CSV_ERR_BAD_CHAR);
+        p->pendingCR = false;
+    }
+    if (c == ',') return CSV_Comma(p);
+    if (c == '\n') return CSV_EndLine(p);
+    p->pendingCR = true;    // '\r', the '\n' that follows (maybe in the next block) ends the line
+    return true;
+}
+
+static bool CSV_Feed(CsvParser *p, const char *data, size_t size)
+{
+    const unsigned char *s = (const unsigned char *)data;
+    size_t i = 0;
+
+#ifdef CSV_HAVE_SSE2
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, comma), _mm_cmpeq_epi8(chunk, lf)),
+                                    _mm_cmpeq_epi8(chunk, cr));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(hits);
+
+        size_t start = 0;
+        while (mask) {
+            size_t at = (size_t)CSV_Ctz(mask);
+            if (at > start && !CSV_TokenBytes(p, s + i + start, at - start)) return false;
+            if (!CSV_Delimiter(p, s[i + at])) return false;
+            start = at + 1;
+            mask &= mask - 1;
+        }
+        if (start < 16 && !CSV_TokenBytes(p, s + i + start, 16 - start)) return false;
+    }
+#endif
+
+    // tail (or everything, without SSE2)
+    size_t start = i;
+    for (; i < size; i++) {
+        unsigned char c = s[i];
+        if (c == ',' || c == '\n' || c == '\r') {
+            if (i > start && !CSV_TokenBytes(p, s + start, i - start)) return false;
+            if (!CSV_Delimiter(p, c)) return false;
+            start = i + 1;
+        }
+    }
+    if (i > start && !CSV_TokenBytes(p, s + start, i - start)) return false;
+
+    p->result.bytesRead += size;
+    return true;
+}
+
+static CsvStatus CSV_Finish(CsvParser *p)
+{
+    if (p->result.status != CSV_OK) return p->result.status;
+
+    if (p->pendingCR) {
+        CSV_Fail(p, CSV_ERR_BAD_CHAR);
+        return p->result.status;
+    }
+
+    // last line without a newline
+    if (!CSV_EndLine(p)) return p->result.status;
+
+    if (p->row < p->rows) {
+        CSV_Fail(p, CSV_ERR_TOO_FEW_ROWS);
+        return p->result.status;
+    }
+    p->result.row = p->row;
+    p->result.column = p->cols;
+    return CSV_OK;
+}
+
+static void CSV_Begin(CsvParser *p, int rows, int cols, int *out)
+{
+    memset(p, 0, sizeof(CsvParser));
+    p->rows = rows;
+    p->cols = cols;
+    p->out = out;
+}
+
+CsvStatus CSV_ParseTilesBuffer(const char *data, size_t size, int rows, int cols, int *out, CsvResult *result)
+{
+    CsvParser p;
+    CSV_Begin(&p, rows, cols, out);
+
+    CsvStatus status = CSV_Feed(&p, data, size) ? CSV_Finish(&p) : p.result.status;
+    if (result) *result = p.result;
+    return status;
+}
+
+CsvStatus CSV_ParseTiles(const char *path, int rows, int cols, int *out, CsvResult *result)
+{
+    CsvParser p;
+    CSV_Begin(&p, rows, cols, out);
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        p.result.status = CSV_ERR_OPEN;
+        if (result) *result = p.result;
+        return CSV_ERR_OPEN;
+    }
+
+    char *block = malloc(CSV_BLOCK_SIZE);
+    if (!block) {
+        fclose(f);
+        p.result.status = CSV_ERR_NOMEM;
+        if (result) *result = p.result;
+        return CSV_ERR_NOMEM;
+    }
+
+    CsvStatus status = CSV_OK;
+    for (;;) {
+        size_t n = fread(block, 1, CSV_BLOCK_SIZE, f);
+        if (n > 0 && !CSV_Feed(&p, block, n)) {
+            status = p.result.status;
+            break;
+        }
+        if (n < CSV_BLOCK_SIZE) {
+            if (ferror(f)) {
+                p.result.status = status = CSV_ERR_READ;
+            } else {
+                status = CSV_Finish(&p);
+            }
+            break;
+        }
+    }
+
+    free(block);
+    fclose(f);
+    if (result) *result = p.result;
+    return status;
+}
+
+const char *CSV_StatusString(CsvStatus status)
+{
+    switch (status) {
+        case CSV_OK:                    return "ok";
+        case CSV_ERR_OPEN:              return "could not open file";
+        case CSV_ERR_READ:              return "read error";
+        case CSV_ERR_NOMEM:             return "out of memory";
+        case CSV_ERR_BAD_CHAR:          return "unexpected character";
+        case CSV_ERR_EMPTY_FIELD:       return "empty field";
+        case CSV_ERR_OVERFLOW:          return "number out of range";
+        case CSV_ERR_TOO_MANY_COLUMNS:  return "more columns than levelColumns";
+        case CSV_ERR_TOO_FEW_COLUMNS:   return "fewer columns than levelColumns";
+        case CSV_ERR_TOO_MANY_ROWS:     return "more rows than levelRows";
+        case CSV_ERR_TOO_FEW_ROWS:      return "fewer rows than levelRows";
+    }
+    return "unknown error";
+}
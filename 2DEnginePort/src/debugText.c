@@ -0,0 +1,78 @@
+#include "debugText.h"
+
+#include <string.h>
+
+// One byte per row, bit 2 is the left column
+static const Uint8 digitGlyphs[10][DEBUGTEXT_GLYPH_H] = {
+    {7, 5, 5, 5, 7}, {2, 6, 2, 2, 7}, {7, 1, 7, 4, 7}, {7, 1, 7, 1, 7}, {5, 5, 7, 1, 1},
+    {7, 4, 7, 1, 7}, {7, 4, 7, 5, 7}, {7, 1, 1, 1, 1}, {7, 5, 7, 5, 7}, {7, 5, 7, 1, 7},
+};
+
+static const Uint8 letterGlyphs[26][DEBUGTEXT_GLYPH_H] = {
+    {2, 5, 7, 5, 5}, {6, 5, 6, 5, 6}, {3, 4, 4, 4, 3}, {6, 5, 5, 5, 6}, {7, 4, 6, 4, 7},
+    {7, 4, 6, 4, 4}, {3, 4, 5, 5, 3}, {5, 5, 7, 5, 5}, {7, 2, 2, 2, 7}, {1, 1, 1, 5, 2},
+    {5, 5, 6, 5, 5}, {4, 4, 4, 4, 7}, {5, 7, 7, 5, 5}, {6, 5, 5, 5, 5}, {2, 5, 5, 5, 2},
+    {6, 5, 6, 4, 4}, {2, 5, 5, 6, 3}, {6, 5, 6, 5, 5}, {3, 4, 2, 1, 6}, {7, 2, 2, 2, 2},
+    {5, 5, 5, 5, 7}, {5, 5, 5, 5, 2}, {5, 5, 7, 7, 5}, {5, 5, 2, 5, 5}, {5, 5, 2, 2, 2},
+    {7, 1, 2, 4, 7},
+};
+
+static const Uint8 *DebugText_Glyph(char c)
+{
+    static const Uint8 dot[] = {0, 0, 0, 0, 2};
+    static const Uint8 colon[] = {0, 2, 0, 2, 0};
+    static const Uint8 dash[] = {0, 0, 7, 0, 0};
+    static const Uint8 underscore[] = {0, 0, 0, 0, 7};
+    static const Uint8 slash[] = {1, 1, 2, 4, 4};
+    static const Uint8 open[] = {1, 2, 2, 2, 1};
+    static const Uint8 close[] = {4, 2, 2, 2, 4};
+    static const Uint8 percent[] = {5, 1, 2, 4, 5};
+
+    if (c >= '0' && c <= '9') return digitGlyphs[c - '0'];
+    if (c >= 'A' && c <= 'Z') return letterGlyphs[c - 'A'];
+    if (c >= 'a' && c <= 'z') return letterGlyphs[c - 'a'];
+    switch (c) {
+        case '.': return dot;
+        case ':': return colon;
+        case '-': return dash;
+        case '_': return underscore;
+        case '/': return slash;
+        case '(': return open;
+        case ')': return close;
+        case '%': return percent;
+        default: return NULL;
+    }
+}
+
+int DebugText_Width(const char *text, int scale)
+{
+    return text ? (int)strlen(text) * (DEBUGTEXT_GLYPH_W + 1) * scale : 0;
+}
+
+// Draws with the renderer's current draw color, one FillRects call per string
+void DebugText_Draw(SDL_Renderer *renderer, int x, int y, int scale, const char *text)
+{
+    if (!renderer || !text) return;
+    if (scale < 1) scale = 1;
+
+    SDL_Rect rects[256];
+    int count = 0;
+
+    for (int penX = x; *text; text++, penX += (DEBUGTEXT_GLYPH_W + 1) * scale) {
+        const Uint8 *glyph = DebugText_Glyph(*text);
+        if (!glyph) continue;
+
+        for (int row = 0; row < DEBUGTEXT_GLYPH_H; row++) {
+            for (int col = 0; col < DEBUGTEXT_GLYPH_W; col++) {
+                if (!(glyph[row] & (4 >> col))) continue;
+
+                if (count == SDL_arraysize(rects)) {
+                    SDL_RenderFillRects(renderer, rects, count);
+                    count = 0;
+                }
+                rects[count++] = (SDL_Rect){penX + col * scale, y + row * scale, scale, scale};
+            }
+        }
+    }
+    if (count > 0) SDL_RenderFillRects(renderer, rects, count);
+}
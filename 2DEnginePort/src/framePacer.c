@@ -0,0 +1,106 @@
+#include "framePacer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// SDL_Delay can oversleep by about a scheduler tick, stop sleeping this early
+#define FRAMEPACER_SLEEP_MARGIN_MS 2
+// Below this the wait spins, above it the thread yields between checks
+#define FRAMEPACER_SPIN_US 200
+
+void FramePacer_Init(FramePacer *pacer, int targetFps, bool vsync)
+{
+    if (!pacer) return;
+
+    memset(pacer, 0, sizeof(FramePacer));
+    pacer->frequency = SDL_GetPerformanceFrequency();
+    pacer->frameStart = SDL_GetPerformanceCounter();
+    FramePacer_SetTarget(pacer, targetFps, vsync);
+}
+
+// targetFps <= 0 runs uncapped. With vsync the display sets the pace and the
+// pacer only measures.
+void FramePacer_SetTarget(FramePacer *pacer, int targetFps, bool vsync)
+{
+    if (!pacer) return;
+
+    pacer->vsync = vsync;
+    pacer->frameTicks = (targetFps > 0 && !vsync) ? pacer->frequency / (Uint64)targetFps : 0;
+    pacer->deadline = pacer->frameStart + pacer->frameTicks;
+}
+
+// Starts a frame and returns the seconds since the previous one started
+float FramePacer_BeginFrame(FramePacer *pacer)
+{
+    Uint64 now = SDL_GetPerformanceCounter();
+    float seconds = (float)((double)(now - pacer->frameStart) / pacer->frequency);
+    pacer->frameStart = now;
+
+    pacer->frameMs[pacer->historyIndex] = seconds * 1000.0f;
+    return seconds;
+}
+
+void FramePacer_EndFrame(FramePacer *pacer)
+{
+    Uint64 now = SDL_GetPerformanceCounter();
+    pacer->workMs[pacer->historyIndex] = (float)((double)(now - pacer->frameStart) * 1000.0 / pacer->frequency);
+    pacer->historyIndex = (pacer->historyIndex + 1) % FRAMEPACER_HISTORY;
+    if (pacer->historyCount < FRAMEPACER_HISTORY) pacer->historyCount++;
+
+    if (pacer->frameTicks == 0) return;
+
+    // A frame that ran more than a whole frame late starts a new schedule instead
+    // of rushing the next ones to catch up
+    if (now > pacer->deadline + pacer->frameTicks) {
+        pacer->deadline = now + pacer->frameTicks;
+        return;
+    }
+
+    Uint64 marginTicks = pacer->frequency * FRAMEPACER_SLEEP_MARGIN_MS / 1000;
+    if (now + marginTicks < pacer->deadline) {
+        Uint32 sleepMs = (Uint32)((pacer->deadline - now - marginTicks) * 1000 / pacer->frequency);
+        if (sleepMs > 0) SDL_Delay(sleepMs);
+    }
+
+    Uint64 spinTicks = pacer->frequency * FRAMEPACER_SPIN_US / 1000000;
+    while ((now = SDL_GetPerformanceCounter()) < pacer->deadline) {
+        if (pacer->deadline - now > spinTicks) SDL_Delay(0);
+    }
+
+    // Deadlines follow each other rather than the wake-up time, so oversleeping
+    // one frame doesn't drift the rate
+    pacer->deadline += pacer->frameTicks;
+}
+
+static int FramePacer_CompareFloat(const void *a, const void *b)
+{
+    float fa = *(const float *)a;
+    float fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Statistics over the last FRAMEPACER_HISTORY frames
+void FramePacer_GetStats(const FramePacer *pacer, FrameStats *stats)
+{
+    memset(stats, 0, sizeof(FrameStats));
+    int count = pacer->historyCount;
+    if (count == 0) return;
+
+    float sorted[FRAMEPACER_HISTORY];
+    float frameTotal = 0.0f;
+    float workTotal = 0.0f;
+    for (int i = 0; i < count; i++) {
+        sorted[i] = pacer->frameMs[i];
+        frameTotal += pacer->frameMs[i];
+        workTotal += pacer->workMs[i];
+    }
+    qsort(sorted, count, sizeof(float), FramePacer_CompareFloat);
+
+    stats->samples = count;
+    stats->avgMs = frameTotal / count;
+    stats->minMs = sorted[0];
+    stats->maxMs = sorted[count - 1];
+    stats->p99Ms = sorted[(count * 99) / 100];
+    stats->avgWorkMs = workTotal / count;
+    stats->fps = stats->avgMs > 0.0f ? 1000.0f / stats->avgMs : 0.0f;
+}
@@ -7,11 +7,29 @@
 #include "update.h"
 #include "render.h"
 #include "camera.h"
+#include "levelLoader.h"
+#include "levelPrefetch.h"
+#include "texture.h"
+#include "imageDecoder.h"
+#include "jobSystem.h"
+#include "physicsWorld.h"
+#include "spatialHash.h"
+#include "profiler.h"
 
 #include <stdio.h>
 #include <string.h>
 
 GameManager *GameManager_Create(const char *settingsPath, const char *windowName) {
+    return GameManager_CreateWithLevel(settingsPath, windowName, NULL);
+}
+
+// Same as GameManager_Create but starts on levelName instead of levelPaths.json's
+// defaultLevel (NULL for the default), so only that one level is loaded
+GameManager *GameManager_CreateWithLevel(const char *settingsPath, const char *windowName, const char *levelName) {
+    // Everything until the first frame is recorded as the startup trace
+    PROFILE_INIT();
+    PROFILE_BEGIN("GameManager_Create");
+
     GameManager *gm = calloc(1, sizeof(GameManager));
     if (!gm) {
         fprintf(stderr, "Failed to allocate GameManager\n");
@@ -22,34 +40,69 @@ GameManager *GameManager_Create(const char *settingsPath, const char *windowName
 
     // Load settings
     printf("Loading settings\n");
+    PROFILE_BEGIN("Settings_Init");
     if (!Settings_Init(&gm->settings, settingsPath))
     {
         fprintf(stderr, "Failed to load settings\n");
         GameManager_Destroy(gm, 1);
         return NULL;
     }
+    PROFILE_END();
     printf("Intializing systems\n");
 
     // Initialize SDL, window, renderer
+    PROFILE_BEGIN("initalizeSystems");
     if (!initalizeSystems(gm)) {
         fprintf(stderr, "Failed to initialize systems\n");
         GameManager_Destroy(gm, 1);
         return NULL;
     }
+    PROFILE_END();
+
+    PROFILE_BEGIN("Worker pools");
+    gm->jobs = JobSystem_Create(0);
+    if (!gm->jobs) {
+        fprintf(stderr, "Failed to create job system\n");
+        GameManager_Destroy(gm, 1);
+        return NULL;
+    }
+
+    gm->physics = PhysicsWorld_Create(256);
+    gm->broadphase = SpatialHash_Create(SPATIAL_CELL_SIZE);
+    if (!gm->physics || !gm->broadphase) {
+        fprintf(stderr, "Failed to create physics world\n");
+        GameManager_Destroy(gm, 1);
+        return NULL;
+    }
 
-    // TODO: Create texture cache
-    // gm->cache = TextureCache_Create(...);
+    // Without a pool images are still decoded, just one at a time on the loading thread
+    gm->decoder = ImageDecoder_Create(gm->mainSystems.renderer, 0);
+    if (!gm->decoder) {
+        fprintf(stderr, "Failed to start image decoder threads, decoding serially\n");
+    }
+    PROFILE_END();
+
+    gm->cache = TextureCache_Create(gm->mainSystems.renderer, gm->decoder, (size_t)SDL_max(gm->settings.video.textureCacheMB, 0) * 1024 * 1024);
+    if (!gm->cache) {
+        fprintf(stderr, "Failed to create texture cache\n");
+        GameManager_Destroy(gm, 1);
+        return NULL;
+    }
 
     printf("Loading Player\n");
     // Create and load player
+    PROFILE_BEGIN("Player_LoadConfig");
     gm->player = calloc(1, sizeof(Player));
-    if (!gm->player || !Player_LoadConfig(gm->player, &gm->mainSystems, "player.json")) {
+    if (!gm->player || !Player_LoadConfig(gm->player, gm->cache, "player.json") ||
+        !Player_AttachPhysics(gm->player, gm->physics)) {
         fprintf(stderr, "Failed to load player\n");
         GameManager_Destroy(gm, 1);
         return NULL;
     }
+    PROFILE_END();
 
     // Load level paths
+    PROFILE_BEGIN("Level loaders");
     gm->levelPaths = levelPaths("levelPaths.json");
     if (!gm->levelPaths) {
         fprintf(stderr, "Failed to load level paths\n");
@@ -57,18 +110,39 @@ GameManager *GameManager_Create(const char *settingsPath, const char *windowName
         return NULL;
     }
 
-    // Load default level
-    if (!GameManager_LoadLevel(gm, gm->levelPaths->defaultLevel)) {
-        fprintf(stderr, "Failed to load default level\n");
+    gm->levelLoader = LevelLoader_Create(gm->cache);
+    if (!gm->levelLoader) {
+        fprintf(stderr, "Failed to create level loader\n");
         GameManager_Destroy(gm, 1);
         return NULL;
     }
 
+    gm->prefetcher = LevelPrefetcher_Create((size_t)SDL_max(gm->settings.video.prefetchMB, 0) * 1024 * 1024, gm->cache);
+    if (!gm->prefetcher) {
+        fprintf(stderr, "Failed to create level prefetcher\n");
+        GameManager_Destroy(gm, 1);
+        return NULL;
+    }
+    PROFILE_END();
+
+    // Load the first level
+    PROFILE_BEGIN("First level");
+    if (!levelName) levelName = gm->levelPaths->defaultLevel;
+    if (!GameManager_LoadLevel(gm, levelName)) {
+        fprintf(stderr, "Failed to load level '%s'\n", levelName);
+        GameManager_Destroy(gm, 1);
+        return NULL;
+    }
+    PROFILE_END();
+
     Camera_Init(&gm->camera, gm->settings.video.width, gm->settings.video.height);
+    SpriteBatch_Init(&gm->sprites);
+    FramePacer_Init(&gm->pacer, gm->settings.video.targetFps, gm->settings.video.vsync);
     Settings_ApplyControls(gm->player, &gm->settings.controls);
     printf("Applied controls\n");
     gm->running = true;
     gm->state = GAMESTATE_RUNNING;
+    PROFILE_END();
     return gm;
 }
 
@@ -84,6 +158,12 @@ void GameManager_Destroy(GameManager *gm, int exitCode) {
     }
     printf("Freed Player\n");
 
+    // Waits for a background load still in flight, its textures need the renderer
+    LevelLoader_Destroy(gm->levelLoader);
+    gm->levelLoader = NULL;
+    LevelPrefetcher_Destroy(gm->prefetcher);
+    gm->prefetcher = NULL;
+
     // Unload level
     if (gm->level) {
         GameManager_UnloadLevel(gm);
@@ -93,8 +173,25 @@ void GameManager_Destroy(GameManager *gm, int exitCode) {
     // Destroy enemies
     // if (gm->enemies) { EnemyManager_Destroy(gm->enemies); free(gm->enemies); }
 
-    // Destroy texture cache
-    // if (gm->cache) { TextureCache_Destroy(gm->cache); }
+    // Everything holding cached textures is gone by now
+    TextureCache_Destroy(gm->cache);
+    gm->cache = NULL;
+    printf("Destroyed texture cache\n");
+    ImageDecoder_Destroy(gm->decoder);
+    gm->decoder = NULL;
+
+    // The player took its body out of the world above
+    SpatialHash_Destroy(gm->broadphase);
+    gm->broadphase = NULL;
+    PhysicsWorld_Destroy(gm->physics);
+    gm->physics = NULL;
+
+    // Last, anything above may still have had jobs in flight
+    JobSystem_Destroy(gm->jobs);
+    gm->jobs = NULL;
+    printf("Destroyed job system\n");
+
+    SpriteBatch_Free(&gm->sprites);
 
     // Free level paths
     if (gm->levelPaths) {
@@ -120,37 +217,83 @@ void GameManager_HandleInput(GameManager *gm) {
 
     SDL_Event event;
 
+    PROFILE_BEGIN("HandleInput");
     processInput(&event, gm);
+    PROFILE_END();
 
 }
 
-void GameManager_Update(GameManager *gm, float deltaTime) {
+// Advances the simulation by fixed steps of 1/simulationHz for the time that passed
+// since the last frame. What's left over carries into the next frame and sets how far
+// rendering interpolates between the last two steps.
+void GameManager_Update(GameManager *gm, float frameTime) {
     if (!gm) return;
 
-    gm->deltaTime = deltaTime;
+    PROFILE_BEGIN("Update");
 
-    Update(gm);
+    // Renderer work queued by jobs since the last frame
+    PROFILE_BEGIN("DrainMain");
+    JobSystem_DrainMain(gm->jobs);
+    PROFILE_END();
+
+    PROFILE_BEGIN("UpdateLevelLoad");
+    GameManager_UpdateLevelLoad(gm);
+    PROFILE_END();
+
+    int hz = gm->settings.gameplay.simulationHz > 0 ? gm->settings.gameplay.simulationHz : 60;
+    int maxSteps = gm->settings.gameplay.maxStepsPerFrame > 0 ? gm->settings.gameplay.maxStepsPerFrame : 1;
+    double step = 1.0 / hz;
+
+    gm->deltaTime = (float)step;
+    gm->simAccumulator += frameTime;
+
+    int steps = 0;
+    while (gm->simAccumulator >= step && steps < maxSteps) {
+        PhysicsBody_StorePrevious(&gm->player->body);
+        Camera_StorePrevious(&gm->camera);
+        Update(gm);
+        gm->simAccumulator -= step;
+        steps++;
+    }
+
+    // After a long hitch, slow down instead of spiralling: drop the backlog
+    if (gm->simAccumulator >= step) {
+        gm->simAccumulator = SDL_fmod(gm->simAccumulator, step);
+    }
+
+    gm->renderAlpha = (float)(gm->simAccumulator / step);
+    PROFILE_END();
+}
+
+// The player just teleported, don't draw it (or the camera) sliding over from the old spot
+static void GameManager_ResetInterpolation(GameManager *gm) {
+    PhysicsBody_StorePrevious(&gm->player->body);
+    Camera_StorePrevious(&gm->camera);
 }
 
 void GameManager_Render(GameManager *gm) {
     if (!gm) return;
 
+    PROFILE_BEGIN("Render");
     render(gm);
+    PROFILE_END();
 
 }
 
-bool GameManager_LoadLevel(GameManager *gm, const char *levelName) {
-    if (!gm || !levelName) return false;
-
-    // Find the level path
-    const char *foundPath = NULL;
+static const char *GameManager_FindLevelPath(GameManager *gm, const char *levelName) {
     for (int i = 0; i < gm->levelPaths->count; i++) {
         if (strcmp(gm->levelPaths->levels[i].name, levelName) == 0) {
-            foundPath = gm->levelPaths->levels[i].path;
-            break;
+            return gm->levelPaths->levels[i].path;
         }
     }
+    return NULL;
+}
 
+bool GameManager_LoadLevel(GameManager *gm, const char *levelName) {
+    if (!gm || !levelName) return false;
+
+    // Find the level path
+    const char *foundPath = GameManager_FindLevelPath(gm, levelName);
     if (!foundPath) {
         fprintf(stderr, "GameManager_LoadLevel: Level '%s' not found\n", levelName);
         return false;
@@ -161,8 +304,13 @@ bool GameManager_LoadLevel(GameManager *gm, const char *levelName) {
         GameManager_UnloadLevel(gm);
     }
 
-    // Load the level from JSON
-    gm->level = loadLevelFromJSON(foundPath, gm);
+    // Finish the prefetcher's staged copy if it has one, otherwise load from scratch
+    LevelLoader *staged = LevelPrefetcher_Claim(gm->prefetcher, levelName, gm->levelLoader);
+    if (staged) {
+        gm->levelLoader = staged;
+        gm->level = LevelLoader_Finish(staged, NULL);
+    }
+    if (!gm->level) gm->level = loadLevelFromJSON(foundPath, gm);
     if (!gm->level) {
         fprintf(stderr, "GameManager_LoadLevel: Failed to load '%s'\n", levelName);
         return false;
@@ -174,11 +322,91 @@ bool GameManager_LoadLevel(GameManager *gm, const char *levelName) {
 
     // Position the player at spawn
     spawnPlayerOnAnyCollidable(gm->player, gm->level->spawnColumn, gm->level, true);
+    GameManager_ResetInterpolation(gm);
 
     return true;
 }
 
 
+// Starts loading a level in the background. The current level keeps running until
+// GameManager_UpdateLevelLoad has the new one fully uploaded, then they're swapped.
+bool GameManager_LoadLevelAsync(GameManager *gm, const char *levelName) {
+    if (!gm || !levelName) return false;
+
+    const char *foundPath = GameManager_FindLevelPath(gm, levelName);
+    if (!foundPath) {
+        fprintf(stderr, "GameManager_LoadLevelAsync: Level '%s' not found\n", levelName);
+        return false;
+    }
+
+    if (LevelLoader_IsBusy(gm->levelLoader)) {
+        fprintf(stderr, "GameManager_LoadLevelAsync: Already loading a level, ignoring '%s'\n", levelName);
+        return false;
+    }
+
+    // Already staged by the prefetcher, only the upload is left
+    LevelLoader *staged = LevelPrefetcher_Claim(gm->prefetcher, levelName, gm->levelLoader);
+    if (staged) {
+        gm->levelLoader = staged;
+        return true;
+    }
+
+    return LevelLoader_Start(gm->levelLoader, levelName, foundPath);
+}
+
+// The level's own "nextLevel" hint, otherwise the entry after the current level in
+// levelPaths.json, wrapping around to the first
+const char *GameManager_NextLevelName(GameManager *gm) {
+    if (!gm || !gm->levelPaths || gm->levelPaths->count == 0) return NULL;
+
+    if (gm->level && gm->level->nextLevel && GameManager_FindLevelPath(gm, gm->level->nextLevel)) {
+        return gm->level->nextLevel;
+    }
+
+    for (int i = 0; i < gm->levelPaths->count; i++) {
+        if (gm->currentLevelName && strcmp(gm->levelPaths->levels[i].name, gm->currentLevelName) == 0) {
+            return gm->levelPaths->levels[(i + 1) % gm->levelPaths->count].name;
+        }
+    }
+    return gm->levelPaths->levels[0].name;
+}
+
+// Called every frame, spends at most settings.video.uploadBudgetMs on the pending level.
+// With nothing loading, the prefetcher gets to stage the next level instead.
+void GameManager_UpdateLevelLoad(GameManager *gm) {
+    if (!gm) return;
+
+    if (!LevelLoader_IsBusy(gm->levelLoader)) {
+        const char *next = GameManager_NextLevelName(gm);
+        if (next && gm->currentLevelName && strcmp(next, gm->currentLevelName) != 0) {
+            LevelPrefetcher_Update(gm->prefetcher, next, GameManager_FindLevelPath(gm, next));
+        }
+        return;
+    }
+
+    LevelLoadState state = LevelLoader_Update(gm->levelLoader, gm->settings.video.uploadBudgetMs);
+    if (state != LEVELLOAD_READY && state != LEVELLOAD_FAILED) return;
+
+    char *levelName = NULL;
+    Level *loaded = LevelLoader_Take(gm->levelLoader, &levelName);
+    if (!loaded) {
+        // Keep playing the current level
+        fprintf(stderr, "GameManager_UpdateLevelLoad: Failed to load '%s'\n", levelName ? levelName : "?");
+        free(levelName);
+        return;
+    }
+
+    if (gm->level) {
+        GameManager_UnloadLevel(gm);
+    }
+    gm->level = loaded;
+    gm->currentLevelName = levelName;
+
+    spawnPlayerOnAnyCollidable(gm->player, gm->level->spawnColumn, gm->level, true);
+    GameManager_ResetInterpolation(gm);
+}
+
+
 void GameManager_UnloadLevel(GameManager *gm) {
     if (!gm || !gm->level) return;
 
@@ -0,0 +1,212 @@
+#include "imageDecoder.h"
+#include "counters.h"
+
+#include <SDL_image.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define IMAGE_DECODER_MAX_THREADS 8
+
+// First format the renderer takes natively that has an alpha channel, so
+// SDL_UpdateTexture doesn't have to convert on upload
+static Uint32 ImageDecoder_NativeFormat(SDL_Renderer *renderer)
+{
+    SDL_RendererInfo info;
+    if (renderer && SDL_GetRendererInfo(renderer, &info) == 0) {
+        for (Uint32 i = 0; i < info.num_texture_formats; i++) {
+            Uint32 format = info.texture_formats[i];
+            if (!SDL_ISPIXELFORMAT_FOURCC(format) && SDL_ISPIXELFORMAT_ALPHA(format)) return format;
+        }
+    }
+    return SDL_PIXELFORMAT_ARGB8888;
+}
+
+static SDL_Surface *ImageDecoder_Decode(const char *path, Uint32 format)
+{
+    SDL_Surface *surf = IMG_Load(path);
+    if (!surf) {
+        fprintf(stderr, "[ImageDecoder] Failed to load '%s': %s\n", path, IMG_GetError());
+        return NULL;
+    }
+    COUNTER_ADD(COUNTER_IMAGES_DECODED, 1);
+    if (surf->format->format == format) return surf;
+
+    SDL_Surface *converted = SDL_ConvertSurfaceFormat(surf, format, 0);
+    SDL_FreeSurface(surf);
+    if (!converted) {
+        fprintf(stderr, "[ImageDecoder] Failed to convert '%s': %s\n", path, SDL_GetError());
+    }
+    return converted;
+}
+
+void ImageFuture_Release(ImageFuture *future)
+{
+    if (!future) return;
+    if (SDL_AtomicAdd(&future->refs, -1) != 1) return;
+
+    SDL_FreeSurface(future->surf);
+    free(future->path);
+    free(future);
+}
+
+// Caller holds the lock
+static void ImageDecoder_Complete(ImageDecoder *decoder, ImageFuture *future)
+{
+    SDL_AtomicSet(&future->done, 1);
+    SDL_CondBroadcast(decoder->jobDone);
+}
+
+static int ImageDecoder_Worker(void *data)
+{
+    ImageDecoder *decoder = data;
+
+    SDL_LockMutex(decoder->lock);
+    for (;;) {
+        while (!decoder->queueHead && !decoder->quit) {
+            SDL_CondWait(decoder->jobReady, decoder->lock);
+        }
+        if (decoder->quit) break;
+
+        ImageFuture *future = decoder->queueHead;
+        decoder->queueHead = future->next;
+        if (!decoder->queueHead) decoder->queueTail = NULL;
+        future->next = NULL;
+        SDL_UnlockMutex(decoder->lock);
+
+        SDL_Surface *surf = ImageDecoder_Decode(future->path, decoder->format);
+
+        SDL_LockMutex(decoder->lock);
+        future->surf = surf;
+        ImageDecoder_Complete(decoder, future);
+        ImageFuture_Release(future);
+    }
+    SDL_UnlockMutex(decoder->lock);
+    return 0;
+}
+
+// threadCount <= 0 picks one worker per core but one, leaving the main thread its own
+ImageDecoder *ImageDecoder_Create(SDL_Renderer *renderer, int threadCount)
+{
+    if (threadCount <= 0) threadCount = SDL_GetCPUCount() - 1;
+    threadCount = SDL_clamp(threadCount, 1, IMAGE_DECODER_MAX_THREADS);
+
+    ImageDecoder *decoder = calloc(1, sizeof(ImageDecoder));
+    if (!decoder) return NULL;
+
+    decoder->format = ImageDecoder_NativeFormat(renderer);
+    decoder->lock = SDL_CreateMutex();
+    decoder->jobReady = SDL_CreateCond();
+    decoder->jobDone = SDL_CreateCond();
+    decoder->threads = calloc(threadCount, sizeof(SDL_Thread *));
+    if (!decoder->lock || !decoder->jobReady || !decoder->jobDone || !decoder->threads) {
+        ImageDecoder_Destroy(decoder);
+        return NULL;
+    }
+
+    for (int i = 0; i < threadCount; i++) {
+        decoder->threads[i] = SDL_CreateThread(ImageDecoder_Worker, "ImageDecoder", decoder);
+        if (!decoder->threads[i]) {
+            fprintf(stderr, "[ImageDecoder] Failed to start worker %d: %s\n", i, SDL_GetError());
+            break;
+        }
+        decoder->threadCount++;
+    }
+    if (decoder->threadCount == 0) {
+        ImageDecoder_Destroy(decoder);
+        return NULL;
+    }
+
+    fprintf(stderr, "[ImageDecoder] %d worker(s), decoding to %s\n", decoder->threadCount, SDL_GetPixelFormatName(decoder->format));
+    return decoder;
+}
+
+// Jobs nobody picked up yet complete as failures, so whoever still waits on them returns
+void ImageDecoder_Destroy(ImageDecoder *decoder)
+{
+    if (!decoder) return;
+
+    if (decoder->lock) {
+        SDL_LockMutex(decoder->lock);
+        decoder->quit = true;
+        SDL_CondBroadcast(decoder->jobReady);
+        SDL_UnlockMutex(decoder->lock);
+    }
+    for (int i = 0; i < decoder->threadCount; i++) {
+        SDL_WaitThread(decoder->threads[i], NULL);
+    }
+
+    while (decoder->queueHead) {
+        ImageFuture *future = decoder->queueHead;
+        decoder->queueHead = future->next;
+        ImageDecoder_Complete(decoder, future);
+        ImageFuture_Release(future);
+    }
+
+    free(decoder->threads);
+    if (decoder->jobDone) SDL_DestroyCond(decoder->jobDone);
+    if (decoder->jobReady) SDL_DestroyCond(decoder->jobReady);
+    if (decoder->lock) SDL_DestroyMutex(decoder->lock);
+    free(decoder);
+}
+
+// Queues `path` for decoding. Without a decoder the image is decoded right here and
+// the future comes back already complete. NULL only when out of memory.
+ImageFuture *ImageDecoder_Submit(ImageDecoder *decoder, const char *path)
+{
+    if (!path) return NULL;
+
+    ImageFuture *future = calloc(1, sizeof(ImageFuture));
+    if (!future) return NULL;
+    future->path = _strdup(path);
+    if (!future->path) {
+        free(future);
+        return NULL;
+    }
+
+    if (!decoder) {
+        future->surf = ImageDecoder_Decode(path, SDL_PIXELFORMAT_ARGB8888);
+        SDL_AtomicSet(&future->refs, 1);
+        SDL_AtomicSet(&future->done, 1);
+        return future;
+    }
+
+    SDL_AtomicSet(&future->refs, 2);
+    SDL_LockMutex(decoder->lock);
+    if (decoder->queueTail) decoder->queueTail->next = future;
+    else decoder->queueHead = future;
+    decoder->queueTail = future;
+    SDL_CondSignal(decoder->jobReady);
+    SDL_UnlockMutex(decoder->lock);
+    return future;
+}
+
+bool ImageFuture_IsReady(const ImageFuture *future)
+{
+    return future && SDL_AtomicGet((SDL_atomic_t *)&future->done);
+}
+
+// Blocks until the future completes. The surface stays owned by the future.
+SDL_Surface *ImageFuture_Wait(ImageDecoder *decoder, ImageFuture *future)
+{
+    if (!future) return NULL;
+
+    if (decoder && !ImageFuture_IsReady(future)) {
+        SDL_LockMutex(decoder->lock);
+        while (!ImageFuture_IsReady(future)) {
+            SDL_CondWait(decoder->jobDone, decoder->lock);
+        }
+        SDL_UnlockMutex(decoder->lock);
+    }
+    return future->surf;
+}
+
+// Moves the decoded surface out of a completed future, the caller frees it
+SDL_Surface *ImageFuture_TakeSurface(ImageFuture *future)
+{
+    if (!ImageFuture_IsReady(future)) return NULL;
+
+    SDL_Surface *surf = future->surf;
+    future->surf = NULL;
+    return surf;
+}
@@ -1,6 +1,7 @@
 #include <SDL.h>
 #include <SDL_image.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "init.h"
 #include "gameManager.h"
@@ -24,7 +25,9 @@ bool initalizeSystems(GameManager *gm) {
         return false;
     }
 
-    Uint32 windowFlags = SDL_WINDOW_OPENGL;
+    // The dummy driver (headless benchmark) can't create OpenGL windows
+    const char *videoDriver = SDL_GetCurrentVideoDriver();
+    Uint32 windowFlags = (videoDriver && strcmp(videoDriver, "dummy") == 0) ? 0 : SDL_WINDOW_OPENGL;
     if (gm->settings.video.fullscreen)
         windowFlags |= SDL_WINDOW_FULLSCREEN;
 
@@ -2,9 +2,13 @@
 #include "init.h"
 #include "gameManager.h"
 #include "player.h"
+#include "level.h"
+#include "profiler.h"
+#include "textureAtlas.h"
 
 #include <SDL.h>
 #include <stdbool.h>
+#include <stdio.h>
 
 
 void processInput(SDL_Event *event, GameManager *gm)
@@ -20,6 +24,15 @@ void processInput(SDL_Event *event, GameManager *gm)
                 gm->running = false;
                 break;
 
+            // Render target contents were lost, atlases and baked chunks need redrawing
+            case SDL_RENDER_TARGETS_RESET:
+                if (gm->player) TextureAtlas_Redraw(gm->player->atlas);
+                if (gm->level) {
+                    TextureAtlas_Redraw(gm->level->atlas);
+                    ChunkCache_InvalidateAll(gm->level->chunkCache);
+                }
+                break;
+
             case SDL_KEYDOWN:
                 switch (event->key.keysym.scancode)
                 {
@@ -52,6 +65,28 @@ void processInput(SDL_Event *event, GameManager *gm)
                     case SDL_SCANCODE_F1:
                         gm->settings.gameplay.debugMode = !gm->settings.gameplay.debugMode;
                         break;
+
+                    // Debug: switch to the next level through the background loader
+                    case SDL_SCANCODE_F2:
+                        if (gm->settings.gameplay.debugMode) {
+                            GameManager_LoadLevelAsync(gm, GameManager_NextLevelName(gm));
+                        }
+                        break;
+                    // Debug: frame time statistics over the last couple of seconds
+                    case SDL_SCANCODE_F3:
+                        if (gm->settings.gameplay.debugMode) {
+                            FrameStats stats;
+                            FramePacer_GetStats(&gm->pacer, &stats);
+                            fprintf(stderr, "[FramePacer] %.1f FPS, avg %.2f ms (work %.2f ms), min %.2f, max %.2f, p99 %.2f ms\n",
+                                    stats.fps, stats.avgMs, stats.avgWorkMs, stats.minMs, stats.maxMs, stats.p99Ms);
+                        }
+                        break;
+                    // Debug: dump the startup phases and the recent frames for chrome://tracing
+                    case SDL_SCANCODE_F5:
+                        if (gm->settings.gameplay.debugMode) {
+                            Profiler_ExportTrace("profile_trace.json");
+                        }
+                        break;
                     default:
                         if (event->key.keysym.scancode == SDL_SCANCODE_F4 &&
                             (SDL_GetModState() & KMOD_ALT)) {
@@ -0,0 +1,419 @@
+#include "jobSystem.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JOB_DEQUE_MIN_CAPACITY 256
+#define JOB_SYSTEM_MAX_THREADS 32
+#define JOB_IDLE_WAIT_MS 5          // bounds a missed wake-up, workers sleep at most this long with work queued
+#define JOB_BATCHES_PER_THREAD 4    // parallel_for splits into this many batches per thread for balancing
+
+struct JobContinuation {
+    Job job;
+    JobContinuation *next;
+};
+
+typedef struct {
+    JobRangeFunc func;
+    void *data;
+    int begin, end;
+} JobRange;
+
+static bool JobDeque_Init(JobDeque *dq)
+{
+    dq->capacity = JOB_DEQUE_MIN_CAPACITY;
+    dq->jobs = malloc(sizeof(Job) * dq->capacity);
+    return dq->jobs != NULL;
+}
+
+static bool JobDeque_Push(JobDeque *dq, const Job *job)
+{
+    SDL_AtomicLock(&dq->lock);
+    if (dq->tail - dq->head == dq->capacity) {
+        Job *jobs = malloc(sizeof(Job) * dq->capacity * 2);
+        if (!jobs) {
+            SDL_AtomicUnlock(&dq->lock);
+            return false;
+        }
+        for (int i = dq->head; i < dq->tail; i++) {
+            jobs[i - dq->head] = dq->jobs[i & (dq->capacity - 1)];
+        }
+        free(dq->jobs);
+        dq->jobs = jobs;
+        dq->tail -= dq->head;
+        dq->head = 0;
+        dq->capacity *= 2;
+    }
+    dq->jobs[dq->tail & (dq->capacity - 1)] = *job;
+    dq->tail++;
+    SDL_AtomicUnlock(&dq->lock);
+    return true;
+}
+
+// Owner end, newest first: what was just pushed is most likely still in cache
+static bool JobDeque_Pop(JobDeque *dq, Job *job)
+{
+    SDL_AtomicLock(&dq->lock);
+    bool found = dq->tail > dq->head;
+    if (found) {
+        dq->tail--;
+        *job = dq->jobs[dq->tail & (dq->capacity - 1)];
+        if (dq->tail == dq->head) dq->tail = dq->head = 0;
+    }
+    SDL_AtomicUnlock(&dq->lock);
+    return found;
+}
+
+// Thief end, oldest first: older jobs tend to be the bigger ones
+static bool JobDeque_Steal(JobDeque *dq, Job *job)
+{
+    SDL_AtomicLock(&dq->lock);
+    bool found = dq->tail > dq->head;
+    if (found) {
+        *job = dq->jobs[dq->head & (dq->capacity - 1)];
+        dq->head++;
+        if (dq->tail == dq->head) dq->tail = dq->head = 0;
+    }
+    SDL_AtomicUnlock(&dq->lock);
+    return found;
+}
+
+// Deque index of the calling thread, -1 for threads outside the pool
+static int JobSystem_Self(JobSystem *js)
+{
+    return (int)(intptr_t)SDL_TLSGet(js->workerSlot) - 1;
+}
+
+static void JobSystem_Execute(JobSystem *js, Job *job);
+
+static void JobSystem_Push(JobSystem *js, Job *job)
+{
+    int self = JobSystem_Self(js);
+    if (self < 0) {
+        self = 1 + (int)((unsigned)SDL_AtomicAdd(&js->nextExternal, 1) % (unsigned)js->threadCount);
+    }
+
+    if (!JobDeque_Push(&js->deques[self], job)) {
+        // Out of memory, doing it right away is still correct, just not parallel
+        fprintf(stderr, "[JobSystem] Deque full and can't grow, running job inline\n");
+        JobSystem_Execute(js, job);
+        return;
+    }
+    if (SDL_AtomicGet(&js->sleeping) > 0) SDL_SemPost(js->wake);
+}
+
+// The decrement happens under the counter's lock and nothing touches the counter
+// after the unlock, see JobCounter_IsDone
+static void JobSystem_Finish(JobSystem *js, JobCounter *counter)
+{
+    if (!counter) return;
+
+    JobContinuation *cont = NULL;
+    SDL_AtomicLock(&counter->lock);
+    if (SDL_AtomicAdd(&counter->value, -1) == 1) {
+        cont = counter->continuations;
+        counter->continuations = NULL;
+    }
+    SDL_AtomicUnlock(&counter->lock);
+
+    while (cont) {
+        JobContinuation *next = cont->next;
+        JobSystem_Push(js, &cont->job);
+        free(cont);
+        cont = next;
+    }
+}
+
+static void JobSystem_Execute(JobSystem *js, Job *job)
+{
+    job->func(job->data);
+    JobSystem_Finish(js, job->counter);
+}
+
+// Own deque first, then steal round the others starting next door
+static bool JobSystem_FindJob(JobSystem *js, int self, Job *job)
+{
+    int dequeCount = js->threadCount + 1;
+    if (self >= 0 && JobDeque_Pop(&js->deques[self], job)) return true;
+
+    int start = self >= 0 ? self + 1 : 0;
+    for (int i = 0; i < dequeCount; i++) {
+        int victim = (start + i) % dequeCount;
+        if (victim == self) continue;
+        if (JobDeque_Steal(&js->deques[victim], job)) return true;
+    }
+    return false;
+}
+
+typedef struct {
+    JobSystem *js;
+    int slot;
+} JobWorkerArgs;
+
+static int JobSystem_Worker(void *data)
+{
+    JobWorkerArgs args = *(JobWorkerArgs *)data;
+    free(data);
+
+    JobSystem *js = args.js;
+    SDL_TLSSet(js->workerSlot, (void *)(intptr_t)(args.slot + 1), NULL);
+
+    Job job;
+    while (!SDL_AtomicGet(&js->quit)) {
+        if (JobSystem_FindJob(js, args.slot, &job)) {
+            JobSystem_Execute(js, &job);
+            continue;
+        }
+        SDL_AtomicAdd(&js->sleeping, 1);
+        SDL_SemWaitTimeout(js->wake, JOB_IDLE_WAIT_MS);
+        SDL_AtomicAdd(&js->sleeping, -1);
+    }
+    return 0;
+}
+
+// threadCount <= 0 starts one worker per core but one (the main thread is the last)
+JobSystem *JobSystem_Create(int threadCount)
+{
+    if (threadCount <= 0) threadCount = SDL_GetCPUCount() - 1;
+    threadCount = SDL_clamp(threadCount, 1, JOB_SYSTEM_MAX_THREADS);
+
+    JobSystem *js = calloc(1, sizeof(JobSystem));
+    if (!js) return NULL;
+
+    js->mainThread = SDL_ThreadID();
+    js->workerSlot = SDL_TLSCreate();
+    js->wake = SDL_CreateSemaphore(0);
+    js->mainLock = SDL_CreateMutex();
+    js->threads = calloc(threadCount, sizeof(SDL_Thread *));
+    js->deques = calloc(threadCount + 1, sizeof(JobDeque));
+    js->threadCount = threadCount;
+    if (!js->workerSlot || !js->wake || !js->mainLock || !js->threads || !js->deques) {
+        JobSystem_Destroy(js);
+        return NULL;
+    }
+    for (int i = 0; i <= threadCount; i++) {
+        if (!JobDeque_Init(&js->deques[i])) {
+            JobSystem_Destroy(js);
+            return NULL;
+        }
+    }
+
+    // The creating thread is the main thread and owns deque 0
+    SDL_TLSSet(js->workerSlot, (void *)(intptr_t)1, NULL);
+
+    int started = 0;
+    for (int i = 0; i < threadCount; i++) {
+        JobWorkerArgs *args = malloc(sizeof(JobWorkerArgs));
+        if (args) {
+            args->js = js;
+            args->slot = i + 1;
+            js->threads[i] = SDL_CreateThread(JobSystem_Worker, "JobWorker", args);
+        }
+        if (!js->threads[i]) {
+            free(args);
+            fprintf(stderr, "[JobSystem] Failed to start worker %d: %s\n", i, SDL_GetError());
+            continue;
+        }
+        started++;
+    }
+    if (started == 0) {
+        JobSystem_Destroy(js);
+        return NULL;
+    }
+
+    fprintf(stderr, "[JobSystem] %d worker(s)\n", started);
+    return js;
+}
+
+// Queued jobs that never ran are dropped, their counters never reach zero
+void JobSystem_Destroy(JobSystem *js)
+{
+    if (!js) return;
+
+    SDL_AtomicSet(&js->quit, 1);
+    for (int i = 0; i < js->threadCount; i++) {
+        if (js->wake) SDL_SemPost(js->wake);
+    }
+    for (int i = 0; i < js->threadCount; i++) {
+        if (js->threads && js->threads[i]) SDL_WaitThread(js->threads[i], NULL);
+    }
+
+    if (js->deques) {
+        for (int i = 0; i <= js->threadCount; i++) free(js->deques[i].jobs);
+    }
+    free(js->deques);
+    free(js->threads);
+    free(js->mainJobs);
+    if (js->mainLock) SDL_DestroyMutex(js->mainLock);
+    if (js->wake) SDL_DestroySemaphore(js->wake);
+    if (js->workerSlot) SDL_TLSSet(js->workerSlot, NULL, NULL);
+    free(js);
+}
+
+void JobSystem_Run(JobSystem *js, JobFunc func, void *data, JobCounter *counter)
+{
+    if (!func) return;
+    if (counter) SDL_AtomicAdd(&counter->value, 1);
+
+    Job job = { func, data, counter };
+    if (!js) {
+        JobSystem_Execute(js, &job);
+        return;
+    }
+    JobSystem_Push(js, &job);
+}
+
+// Queues func once every job counted by `dependency` has finished. `counter`
+// covers the new job from now on, so waiting on it also waits for the dependency.
+void JobSystem_RunAfter(JobSystem *js, JobCounter *dependency, JobFunc func, void *data, JobCounter *counter)
+{
+    if (!func) return;
+    if (!dependency || !js) {
+        if (dependency) JobSystem_Wait(js, dependency);
+        JobSystem_Run(js, func, data, counter);
+        return;
+    }
+
+    if (counter) SDL_AtomicAdd(&counter->value, 1);
+    Job job = { func, data, counter };
+
+    JobContinuation *cont = malloc(sizeof(JobContinuation));
+    if (!cont) {
+        JobSystem_Wait(js, dependency);
+        JobSystem_Push(js, &job);
+        return;
+    }
+    cont->job = job;
+
+    // The lock orders this against JobSystem_Finish taking the list: either it sees
+    // the continuation, or the dependency was already at zero here
+    SDL_AtomicLock(&dependency->lock);
+    if (SDL_AtomicGet(&dependency->value) == 0) {
+        SDL_AtomicUnlock(&dependency->lock);
+        free(cont);
+        JobSystem_Push(js, &job);
+        return;
+    }
+    cont->next = dependency->continuations;
+    dependency->continuations = cont;
+    SDL_AtomicUnlock(&dependency->lock);
+}
+
+// For work that touches the renderer. Runs on the main thread during the next
+// JobSystem_DrainMain, or while the main thread waits on a counter.
+void JobSystem_RunOnMain(JobSystem *js, JobFunc func, void *data, JobCounter *counter)
+{
+    if (!func) return;
+    if (counter) SDL_AtomicAdd(&counter->value, 1);
+
+    Job job = { func, data, counter };
+    if (!js) {
+        JobSystem_Execute(js, &job);
+        return;
+    }
+
+    SDL_LockMutex(js->mainLock);
+    if (js->mainCount == js->mainCapacity) {
+        int capacity = js->mainCapacity ? js->mainCapacity * 2 : 64;
+        Job *jobs = realloc(js->mainJobs, sizeof(Job) * capacity);
+        if (!jobs) {
+            SDL_UnlockMutex(js->mainLock);
+            fprintf(stderr, "[JobSystem] Main thread queue can't grow, job dropped\n");
+            JobSystem_Finish(js, counter);
+            return;
+        }
+        js->mainJobs = jobs;
+        js->mainCapacity = capacity;
+    }
+    js->mainJobs[js->mainCount++] = job;
+    SDL_UnlockMutex(js->mainLock);
+}
+
+// Runs everything queued for the main thread. Does nothing on other threads.
+void JobSystem_DrainMain(JobSystem *js)
+{
+    if (!js || SDL_ThreadID() != js->mainThread) return;
+
+    // Jobs queued by the jobs below wait for the next drain
+    SDL_LockMutex(js->mainLock);
+    Job *jobs = js->mainJobs;
+    int count = js->mainCount;
+    js->mainJobs = NULL;
+    js->mainCount = 0;
+    js->mainCapacity = 0;
+    SDL_UnlockMutex(js->mainLock);
+
+    for (int i = 0; i < count; i++) {
+        JobSystem_Execute(js, &jobs[i]);
+    }
+    free(jobs);
+}
+
+// Once this returns true the counter may go out of scope. Taking the lock makes sure
+// the thread that brought it to zero has finished with it.
+bool JobCounter_IsDone(JobCounter *counter)
+{
+    if (!counter) return true;
+    if (SDL_AtomicGet(&counter->value) != 0) return false;
+
+    SDL_AtomicLock(&counter->lock);
+    SDL_AtomicUnlock(&counter->lock);
+    return true;
+}
+
+// Blocks until counter reaches zero, running other jobs in the meantime. On the main
+// thread that includes the main thread queue, so waiting there can't deadlock on it.
+void JobSystem_Wait(JobSystem *js, JobCounter *counter)
+{
+    if (!js) return;
+
+    int self = JobSystem_Self(js);
+    bool onMain = SDL_ThreadID() == js->mainThread;
+
+    Job job;
+    while (!JobCounter_IsDone(counter)) {
+        if (onMain) JobSystem_DrainMain(js);
+        if (JobSystem_FindJob(js, self, &job)) {
+            JobSystem_Execute(js, &job);
+        } else {
+            SDL_Delay(0);
+        }
+    }
+}
+
+static void JobSystem_RangeJob(void *data)
+{
+    JobRange *range = data;
+    range->func(range->data, range->begin, range->end);
+}
+
+// Calls func over [0, count) in batches of at least minBatch spread over the pool,
+// and returns once all of them are done. The calling thread takes part.
+void JobSystem_ParallelFor(JobSystem *js, int count, int minBatch, JobRangeFunc func, void *data)
+{
+    if (!func || count <= 0) return;
+    if (minBatch < 1) minBatch = 1;
+
+    int threads = js ? js->threadCount + 1 : 1;
+    int batchSize = (count + threads * JOB_BATCHES_PER_THREAD - 1) / (threads * JOB_BATCHES_PER_THREAD);
+    if (batchSize < minBatch) batchSize = minBatch;
+
+    int batches = (count + batchSize - 1) / batchSize;
+    JobRange *ranges = batches > 1 ? malloc(sizeof(JobRange) * batches) : NULL;
+    if (!ranges) {
+        func(data, 0, count);
+        return;
+    }
+
+    JobCounter counter = { 0 };
+    for (int i = 0; i < batches; i++) {
+        ranges[i].func = func;
+        ranges[i].data = data;
+        ranges[i].begin = i * batchSize;
+        ranges[i].end = SDL_min(count, (i + 1) * batchSize);
+        JobSystem_Run(js, JobSystem_RangeJob, &ranges[i], &counter);
+    }
+    JobSystem_Wait(js, &counter);
+    free(ranges);
+}
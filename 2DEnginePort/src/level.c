@@ -1,18 +1,21 @@
 #include "level.h"
 #include <player.h>
+#include "collision.h"
 
 #include "gameManager.h"
 #include "settings.h"
 #include "utils.h"
+#include "levelBin.h"
+#include "csvParser.h"
+#include "texture.h"
+#include "imageDecoder.h"
+#include "profiler.h"
+#include "counters.h"
+#include "textureAtlas.h"
 
 #include <string.h>
 
 
-
-/*SDL_Texture *getTextureCached(SDL_Renderer *renderer, const char *path) {
-}*/
-
-
 LevelPaths *levelPaths(char *jSONPath)
 {
     // Read the file into a string
@@ -99,32 +102,35 @@ void freeLevelPaths(LevelPaths *lp)
     free(lp);
 }
 
+// Reads a layer CSV into a levelRows x levelCols array. The file has to match the level
+// size exactly, a short or long row is an error instead of silently reading as tile 0.
 int *loadLayerCSV(const char *csvPath, int levelRows, int levelCols)
 {
-    FILE *f = fopen(csvPath, "r");
-    if (!f) return NULL;
-
-    int *tiles = calloc(levelRows * levelCols, sizeof(int));
-    if (!tiles) { fclose(f); return NULL; }
-
-    char line[1024];
-    int row = 0;
-    while (fgets(line, sizeof(line), f) && row < levelRows) {
-        char *token = strtok(line, ",");
-        int col = 0;
-        while (token && col < levelCols) {
-            tiles[row * levelCols + col] = atoi(token);
-            token = strtok(NULL, ",");
-            col++;
+    if (levelRows <= 0 || levelCols <= 0) return NULL;
+
+    int *tiles = calloc((size_t)levelRows * levelCols, sizeof(int));
+    if (!tiles) return NULL;
+
+    CsvResult result;
+    CsvStatus status = CSV_ParseTiles(csvPath, levelRows, levelCols, tiles, &result);
+    COUNTER_ADD(COUNTER_BYTES_READ, result.bytesRead);
+    if (status != CSV_OK) {
+        if (result.status == CSV_ERR_OPEN) {
+            fprintf(stderr, "[Level] ERROR: Could not open CSV: %s\n", csvPath);
+        } else {
+            fprintf(stderr, "[Level] ERROR: %s row %d column %d: %s\n",
+                    csvPath, result.row, result.column, CSV_StatusString(result.status));
         }
-        row++;
+        free(tiles);
+        return NULL;
     }
 
-    fclose(f);
     return tiles;
 }
 
-Level *loadLevelFromJSON(const char *jsonPath, GameManager *gm)
+// Parses the level JSON and every layer CSV. Doesn't touch the renderer, textures are
+// created afterwards by level_uploadTextures, so this is also what the level compiler uses.
+Level *level_parseJSON(const char *jsonPath)
 {
     fprintf(stderr, "[Level] Loading level from JSON: %s\n", jsonPath);
 
@@ -155,11 +161,19 @@ Level *loadLevelFromJSON(const char *jsonPath, GameManager *gm)
     cJSON *spawn = cJSON_GetObjectItemCaseSensitive(jsonFile, "spawnColumn");
     lvl->spawnColumn = cJSON_IsNumber(spawn) ? spawn->valueint : 1;
 
+    // nextLevel, lets the prefetcher pick something other than the next levelPaths entry
+    cJSON *next = cJSON_GetObjectItemCaseSensitive(jsonFile, "nextLevel");
+    if (cJSON_IsString(next) && next->valuestring[0]) {
+        lvl->nextLevel = _strdup(next->valuestring);
+    }
+
     // level rows and columns
     cJSON *cols = cJSON_GetObjectItemCaseSensitive(jsonFile, "levelColumns");
     if (!cJSON_IsNumber(cols)) {
         fprintf(stderr, "[Level] ERROR: %s does not have a valid levelColumns value\n", lvl->name);
         cJSON_Delete(jsonFile);
+        unloadLevel(lvl);
+        free(lvl);
         return NULL;
     } else {
         lvl->levelColumns = cols->valueint;
@@ -169,6 +183,8 @@ Level *loadLevelFromJSON(const char *jsonPath, GameManager *gm)
     if (!cJSON_IsNumber(rows)) {
         fprintf(stderr, "[Level] ERROR: %s does not have a valid levelRows value\n", lvl->name);
         cJSON_Delete(jsonFile);
+        unloadLevel(lvl);
+        free(lvl);
         return NULL;
     } else {
         lvl->levelRows = rows->valueint;
@@ -197,18 +213,10 @@ Level *loadLevelFromJSON(const char *jsonPath, GameManager *gm)
         lvl->tilesets[idx].tileSize = cJSON_IsNumber(tileSize) ? tileSize->valueint : 16;
         lvl->tilesets[idx].tilesPerRow = cJSON_IsNumber(tilesPerRow) ? tilesPerRow->valueint : 8;
         lvl->tilesets[idx].scale = cJSON_IsNumber(scale) ? (float)scale->valuedouble : 2.0f;
-
-        fprintf(stderr, "[Level] Loading tileset image: %s (id: %s)\n", image->valuestring, id->valuestring);
-        SDL_Surface *surf = IMG_Load(image->valuestring);
-        if (!surf) {
-            fprintf(stderr, "[Level] ERROR: Failed to load tileset image '%s' for level '%s'\n", image->valuestring, lvl->name);
-            cJSON_Delete(jsonFile);
-            return NULL;
-        }
-        lvl->tilesets[idx].tex = SDL_CreateTextureFromSurface(gm->mainSystems.renderer, surf);
-        SDL_FreeSurface(surf);
+        lvl->tilesets[idx].imagePath = _strdup(image->valuestring);
         idx++;
     }
+    lvl->tilesetCount = idx;
 
     // loading CSV 
     cJSON *layers = cJSON_GetObjectItemCaseSensitive(jsonFile, "layers");
@@ -234,12 +242,18 @@ Level *loadLevelFromJSON(const char *jsonPath, GameManager *gm)
         lvl->layers[idx].tiles = loadLayerCSV(csv->valuestring, lvl->levelRows, lvl->levelColumns);
         if (!lvl->layers[idx].tiles) {
             fprintf(stderr, "[Level] ERROR: Failed to load CSV '%s' for layer %d in level '%s'\n", csv->valuestring, idx, lvl->name);
+            // Also runs on the loader and prefetch threads, don't leak what was parsed so far
             cJSON_Delete(jsonFile);
+            unloadLevel(lvl);
+            free(lvl);
             return NULL;
         }
 
         lvl->layers[idx].collidable = cJSON_IsTrue(isCollidable);
 
+        cJSON *isStatic = cJSON_GetObjectItemCaseSensitive(ln, "static");
+        lvl->layers[idx].isStatic = cJSON_IsBool(isStatic) ? cJSON_IsTrue(isStatic) : !lvl->layers[idx].collidable;
+
         if (lvl->layers[idx].collidable) {
             cJSON *solidArray = cJSON_GetObjectItemCaseSensitive(ln, "solidTiles");
             if (cJSON_IsArray(solidArray)) {
@@ -258,6 +272,7 @@ Level *loadLevelFromJSON(const char *jsonPath, GameManager *gm)
 
         idx++;
     }
+    lvl->layerCount = idx;
 
     // backgrounds
     cJSON *bgs = cJSON_GetObjectItemCaseSensitive(jsonFile, "backgrounds");
@@ -276,22 +291,370 @@ Level *loadLevelFromJSON(const char *jsonPath, GameManager *gm)
         }
         lvl->bgs[idx].imagePath = _strdup(img->valuestring);
         lvl->bgs[idx].tex = NULL;
-        fprintf(stderr, "[Level] Loading background image: %s (bg %d, level '%s')\n", img->valuestring, idx, lvl->name);
-        SDL_Surface *surf = IMG_Load(img->valuestring);
-        if (!surf) {
-            fprintf(stderr, "[Level] ERROR: Failed to load background image '%s' for level '%s'\n", img->valuestring, lvl->name);
-            cJSON_Delete(jsonFile);
-            return NULL;
-        }
-        lvl->bgs[idx].tex = SDL_CreateTextureFromSurface(gm->mainSystems.renderer, surf);
-        SDL_FreeSurface(surf);
         lvl->bgs[idx].scrollSpeed = cJSON_IsNumber(speed) ? (float)speed->valuedouble : 0.3f;
         lvl->bgs[idx].scale = cJSON_IsNumber(scale) ? (float)scale->valuedouble : 1.f;
         lvl->bgs[idx].offsetY = cJSON_IsNumber(offsetY) ? (float)offsetY->valuedouble : 0.f;
         idx++;
     }
+    lvl->bgCount = idx;
 
     cJSON_Delete(jsonFile);
+    return lvl;
+}
+
+// The i-th image of a level, tilesets first, then backgrounds
+static StagedImage *level_stagedImage(Level *lvl, int i, const char **path)
+{
+    if (i < lvl->tilesetCount) {
+        *path = lvl->tilesets[i].imagePath;
+        return &lvl->tilesets[i].staged;
+    }
+    *path = lvl->bgs[i - lvl->tilesetCount].imagePath;
+    return &lvl->bgs[i - lvl->tilesetCount].staged;
+}
+
+// Decodes every tileset and background image the texture cache doesn't already hold.
+// They all go to the cache's decoder at once and come back in the renderer's native
+// pixel format. No renderer involved, safe on a loader thread.
+bool level_decodeImages(Level *lvl, TextureCache *textures)
+{
+    if (!lvl) return false;
+
+    int count = lvl->tilesetCount + lvl->bgCount;
+    if (count == 0) return true;
+
+    ImageFuture **futures = calloc(count, sizeof(ImageFuture *));
+    if (!futures) return false;
+    ImageDecoder *decoder = textures ? textures->decoder : NULL;
+
+    bool ok = true;
+    for (int i = 0; i < count; i++) {
+        const char *path = NULL;
+        level_stagedImage(lvl, i, &path);
+        if (TextureCache_Contains(textures, path)) continue;
+
+        fprintf(stderr, "[Level] Decoding image: %s (level '%s')\n", path, lvl->name);
+        futures[i] = ImageDecoder_Submit(decoder, path);
+        if (!futures[i]) ok = false;
+    }
+
+    // Every future has to be collected even after a failure, the workers still own them
+    for (int i = 0; i < count; i++) {
+        if (!futures[i]) continue;
+
+        const char *path = NULL;
+        StagedImage *img = level_stagedImage(lvl, i, &path);
+        ImageFuture_Wait(decoder, futures[i]);
+        img->surf = ImageFuture_TakeSurface(futures[i]);
+        img->rowsUploaded = 0;
+        ImageFuture_Release(futures[i]);
+
+        if (!img->surf) {
+            fprintf(stderr, "[Level] ERROR: Failed to load image '%s' for level '%s'\n", path, lvl->name);
+            ok = false;
+        } else if (i < lvl->tilesetCount) {
+            lvl->tilesets[i].texW = img->surf->w;
+            lvl->tilesets[i].texH = img->surf->h;
+        }
+    }
+
+    free(futures);
+    return ok;
+}
+
+// Rows per SDL_UpdateTexture call, roughly 256KB so one band never eats a frame budget by itself
+static int level_uploadBandRows(const SDL_Surface *surf)
+{
+    int rows = (256 * 1024) / (surf->pitch > 0 ? surf->pitch : 1);
+    return rows > 0 ? rows : 1;
+}
+
+// Copies the next band of a staged image into its texture. Returns false on failure.
+static bool level_uploadBand(StagedImage *img, SDL_Texture **tex, SDL_Renderer *renderer)
+{
+    SDL_Surface *surf = img->surf;
+
+    if (!*tex) {
+        *tex = SDL_CreateTexture(renderer, surf->format->format, SDL_TEXTUREACCESS_STATIC, surf->w, surf->h);
+        if (!*tex) {
+            fprintf(stderr, "[Level] ERROR: Failed to create texture: %s\n", SDL_GetError());
+            return false;
+        }
+        SDL_SetTextureBlendMode(*tex, SDL_BLENDMODE_BLEND);
+    }
+
+    int rows = SDL_min(level_uploadBandRows(surf), surf->h - img->rowsUploaded);
+    SDL_Rect band = { 0, img->rowsUploaded, surf->w, rows };
+    const Uint8 *pixels = (const Uint8 *)surf->pixels + (size_t)img->rowsUploaded * surf->pitch;
+    if (SDL_UpdateTexture(*tex, &band, pixels, surf->pitch) != 0) {
+        fprintf(stderr, "[Level] ERROR: Failed to upload texture: %s\n", SDL_GetError());
+        return false;
+    }
+
+    img->rowsUploaded += rows;
+    if (img->rowsUploaded >= surf->h) {
+        SDL_FreeSurface(surf);
+        img->surf = NULL;
+    }
+    return true;
+}
+
+// Gets the image at `path` into *handle. A resident cache entry is used as is, otherwise
+// the staged surface goes up band by band and the finished texture is handed to the cache.
+// Returns true early, with the image unfinished, once the deadline passes.
+static bool level_uploadImage(TextureCache *textures, const char *path, StagedImage *img,
+                              SDL_Texture **tex, CachedTexture **handle, Uint64 deadline)
+{
+    while (!*handle) {
+        if (!img->surf) {
+            // Skipped while decoding because it was resident, but evicted since then
+            *handle = TextureCache_Acquire(textures, path);
+            if (!*handle) return false;
+            break;
+        }
+
+        // Someone else may have loaded the same image while this one was staged
+        if (img->rowsUploaded == 0) {
+            *handle = TextureCache_AcquireLoaded(textures, path);
+            if (*handle) {
+                SDL_FreeSurface(img->surf);
+                img->surf = NULL;
+                break;
+            }
+        }
+
+        if (!level_uploadBand(img, tex, textures->renderer)) return false;
+        if (!img->surf) {
+            *handle = TextureCache_Adopt(textures, path, *tex);
+            if (!*handle) {
+                *tex = NULL;    // Adopt destroys it on failure
+                return false;
+            }
+            break;
+        }
+
+        if (deadline && SDL_GetPerformanceCounter() >= deadline) return true;
+    }
+
+    *tex = (*handle)->tex;
+    return true;
+}
+
+// Heap memory held by a staged level: decoded surfaces, tile arrays (unless they're
+// in a file mapping) and the collision grid. Used against the prefetch memory cap.
+size_t level_stagedBytes(const Level *lvl)
+{
+    if (!lvl) return 0;
+
+    size_t bytes = 0;
+    for (int i = 0; i < lvl->tilesetCount; i++) {
+        const SDL_Surface *surf = lvl->tilesets[i].staged.surf;
+        if (surf) bytes += (size_t)surf->pitch * surf->h;
+    }
+    for (int i = 0; i < lvl->bgCount; i++) {
+        const SDL_Surface *surf = lvl->bgs[i].staged.surf;
+        if (surf) bytes += (size_t)surf->pitch * surf->h;
+    }
+
+    size_t cells = (size_t)lvl->levelRows * lvl->levelColumns;
+    if (!lvl->mapping) bytes += cells * sizeof(int) * lvl->layerCount;
+    if (lvl->solidGrid) bytes += ((cells + 31) / 32) * sizeof(Uint32);
+    return bytes;
+}
+
+// Decoded size of a PNG from its IHDR chunk, 4 bytes a pixel like the renderer formats
+// images are decoded to. 0 when it isn't a PNG or can't be read.
+static size_t level_pngDecodedBytes(const char *path)
+{
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    unsigned char header[24];
+
+    FILE *file = path ? fopen(path, "rb") : NULL;
+    if (!file) return 0;
+    size_t n = fread(header, 1, sizeof(header), file);
+    fclose(file);
+    if (n < sizeof(header) || memcmp(header, signature, sizeof(signature)) != 0) return 0;
+
+    // Width and height, big endian
+    size_t w = (size_t)header[16] << 24 | (size_t)header[17] << 16 | (size_t)header[18] << 8 | header[19];
+    size_t h = (size_t)header[20] << 24 | (size_t)header[21] << 16 | (size_t)header[22] << 8 | header[23];
+    return w * h * 4;
+}
+
+// What level_stagedBytes will be once the images are decoded and the collision grid is
+// built: what's staged so far plus the headers of images not decoded yet. Images the
+// cache holds won't be decoded and don't count.
+static size_t level_estimateStagedBytes(const Level *lvl, TextureCache *textures)
+{
+    size_t cells = (size_t)lvl->levelRows * lvl->levelColumns;
+    size_t bytes = level_stagedBytes(lvl);
+    if (!lvl->solidGrid) bytes += ((cells + 31) / 32) * sizeof(Uint32);
+
+    for (int i = 0; i < lvl->tilesetCount; i++) {
+        if (!lvl->tilesets[i].staged.surf && !TextureCache_Contains(textures, lvl->tilesets[i].imagePath)) {
+            bytes += level_pngDecodedBytes(lvl->tilesets[i].imagePath);
+        }
+    }
+    for (int i = 0; i < lvl->bgCount; i++) {
+        if (!lvl->bgs[i].staged.surf && !TextureCache_Contains(textures, lvl->bgs[i].imagePath)) {
+            bytes += level_pngDecodedBytes(lvl->bgs[i].imagePath);
+        }
+    }
+    return bytes;
+}
+
+static bool level_hasPendingImages(const Level *lvl)
+{
+    for (int i = 0; i < lvl->tilesetCount; i++) {
+        if (!lvl->tilesets[i].handle) return true;
+    }
+    for (int i = 0; i < lvl->bgCount; i++) {
+        if (!lvl->bgs[i].handle) return true;
+    }
+    return false;
+}
+
+// Packs every tileset into one atlas so all tile layers, and the chunks baked from
+// them, draw from the same texture. Tiles get extruded borders so TILE_SCALE
+// upscaling doesn't sample the tile next door. Without an atlas the tilesets keep
+// drawing from their own textures.
+static void level_packTilesets(Level *lvl, SDL_Renderer *renderer)
+{
+    if (lvl->atlas || lvl->tilesetCount <= 0) return;
+
+    AtlasItem *items = calloc(lvl->tilesetCount, sizeof(AtlasItem));
+    if (!items) return;
+
+    for (int i = 0; i < lvl->tilesetCount; i++) {
+        const Tileset *ts = &lvl->tilesets[i];
+        items[i].source = ts->tex;
+        items[i].w = ts->texW;
+        items[i].h = ts->texH;
+        items[i].cellSize = ts->tileSize;
+    }
+
+    lvl->atlas = TextureAtlas_Create(renderer, items, lvl->tilesetCount);
+    if (lvl->atlas) {
+        for (int i = 0; i < lvl->tilesetCount; i++) {
+            if (items[i].page < 0) continue;
+            Tileset *ts = &lvl->tilesets[i];
+            ts->tex = lvl->atlas->pages[items[i].page];
+            ts->texW = lvl->atlas->pageSize;
+            ts->texH = lvl->atlas->pageSize;
+            ts->originX = items[i].x;
+            ts->originY = items[i].y;
+            ts->tileStride = items[i].stride;
+        }
+    }
+    free(items);
+}
+
+// Turns decoded images into textures. With a deadline (a SDL_GetPerformanceCounter value)
+// it stops once the deadline passes and picks up where it left off on the next call;
+// a deadline of 0 uploads everything. *done is set once nothing is left to upload.
+bool level_uploadTextures(Level *lvl, TextureCache *textures, Uint64 deadline, bool *done)
+{
+    if (done) *done = false;
+    if (!lvl || !textures) return false;
+
+    bool outOfTime = false;
+    for (int i = 0; i < lvl->tilesetCount && !outOfTime; i++) {
+        Tileset *ts = &lvl->tilesets[i];
+        if (ts->handle) continue;
+        if (!level_uploadImage(textures, ts->imagePath, &ts->staged, &ts->tex, &ts->handle, deadline)) return false;
+        if (ts->handle) {
+            ts->texW = ts->handle->w;
+            ts->texH = ts->handle->h;
+        }
+        outOfTime = deadline && SDL_GetPerformanceCounter() >= deadline;
+    }
+
+    for (int i = 0; i < lvl->bgCount && !outOfTime; i++) {
+        BackgroundLayer *bg = &lvl->bgs[i];
+        if (bg->handle) continue;
+        if (!level_uploadImage(textures, bg->imagePath, &bg->staged, &bg->tex, &bg->handle, deadline)) return false;
+        outOfTime = deadline && SDL_GetPerformanceCounter() >= deadline;
+    }
+
+    bool finished = !level_hasPendingImages(lvl);
+    if (finished) level_packTilesets(lvl, textures->renderer);
+
+    if (done) *done = finished;
+    return true;
+}
+
+// Everything a level load does except creating textures: the .lvlbin or JSON/CSV,
+// image decoding and the collision grid. Doesn't touch the renderer, so the
+// background loader runs this on its own thread. With a capBytes the load stops as
+// soon as the level is known to stage more than that (0 for no cap): before decoding
+// when the image headers already say so, otherwise right after.
+Level *level_loadStaged(const char *jsonPath, TextureCache *textures, size_t capBytes)
+{
+    Level *lvl = NULL;
+
+    char binPath[512];
+    if (LevelBin_PathFor(jsonPath, binPath, sizeof(binPath)) && LevelBin_IsFresh(binPath, jsonPath)) {
+        lvl = LevelBin_Load(binPath);
+    }
+    if (!lvl) {
+        lvl = level_parseJSON(jsonPath);
+    }
+    if (!lvl) return NULL;
+
+    if (!level_resolve(lvl)) {
+        fprintf(stderr, "[Level] ERROR: Level '%s' has no usable tile size\n", lvl->name);
+        unloadLevel(lvl);
+        free(lvl);
+        return NULL;
+    }
+
+    size_t staged = capBytes ? level_estimateStagedBytes(lvl, textures) : 0;
+    if (staged > capBytes) {
+        fprintf(stderr, "[Level] '%s' would stage about %zu KB, over the %zu KB cap, not loading it\n",
+                lvl->name, staged / 1024, capBytes / 1024);
+        unloadLevel(lvl);
+        free(lvl);
+        return NULL;
+    }
+
+    if (!level_decodeImages(lvl, textures)) {
+        unloadLevel(lvl);
+        free(lvl);
+        return NULL;
+    }
+
+    // Checked again with the real surfaces, for images the headers couldn't size
+    staged = capBytes ? level_estimateStagedBytes(lvl, textures) : 0;
+    if (staged > capBytes) {
+        fprintf(stderr, "[Level] '%s' stages %zu KB, over the %zu KB cap, not keeping it\n",
+                lvl->name, staged / 1024, capBytes / 1024);
+        unloadLevel(lvl);
+        free(lvl);
+        return NULL;
+    }
+
+    if (!level_buildSolidGrid(lvl)) {
+        fprintf(stderr, "[Level] ERROR: Failed to build collision grid for level '%s'\n", lvl->name);
+        unloadLevel(lvl);
+        free(lvl);
+        return NULL;
+    }
+
+    return lvl;
+}
+
+// Loads a level, preferring the compiled .lvlbin next to the JSON when it's up to date
+Level *loadLevelFromJSON(const char *jsonPath, GameManager *gm)
+{
+    Level *lvl = level_loadStaged(jsonPath, gm->cache, 0);
+    if (!lvl) return NULL;
+
+    if (!level_uploadTextures(lvl, gm->cache, 0, NULL)) {
+        unloadLevel(lvl);
+        free(lvl);
+        return NULL;
+    }
+
     fprintf(stderr, "[Level] Successfully loaded level: %s\n", lvl->name);
     return lvl;
 }
@@ -307,50 +670,144 @@ Tileset *findTileset(Level *lvl, const char *id)
     return NULL;
 }
 
-int getLevelTileWidth(Level *lvl) 
+// Resolves everything the per-frame code would otherwise look up by name: each layer's
+// tileset index and scaled tile size, the level's common tile size and pixel bounds.
+// Mismatches are reported here, once, instead of every frame.
+bool level_resolve(Level *lvl)
 {
-    if (!lvl || lvl->tilesetCount == 0) return 0;
-    int firstWidth = (int)(lvl->tilesets[0].tileSize * lvl->tilesets[0].scale);
-    for (int i = 1; i < lvl->tilesetCount; i++) {
-        int w = (int)(lvl->tilesets[i].tileSize * lvl->tilesets[i].scale);
-        if (w != firstWidth) {
-            SDL_Log("Warning: Tileset %s has a different scaled width (%d vs %d)",
-                    lvl->tilesets[i].id, w, firstWidth);
+    if (!lvl) return false;
+
+    for (int i = 0; i < lvl->tilesetCount; i++) {
+        lvl->tilesets[i].originX = 0;
+        lvl->tilesets[i].originY = 0;
+        lvl->tilesets[i].tileStride = lvl->tilesets[i].tileSize;
+    }
+
+    for (int i = 0; i < lvl->layerCount; i++) {
+        Layer *layer = &lvl->layers[i];
+        layer->tilesetIndex = -1;
+        layer->scaledTileSize = 0;
+
+        Tileset *ts = findTileset(lvl, layer->tileset_id);
+        if (!ts) {
+            fprintf(stderr, "[Level] WARNING: Layer %d uses unknown tileset '%s', it won't be drawn\n",
+                    i, layer->tileset_id ? layer->tileset_id : "(none)");
+            continue;
+        }
+        layer->tilesetIndex = (int)(ts - lvl->tilesets);
+        layer->scaledTileSize = (int)(ts->tileSize * ts->scale);
+    }
+
+    lvl->tileSize = 0;
+    if (lvl->tilesetCount > 0) {
+        lvl->tileSize = (int)(lvl->tilesets[0].tileSize * lvl->tilesets[0].scale);
+        for (int i = 1; i < lvl->tilesetCount; i++) {
+            int w = (int)(lvl->tilesets[i].tileSize * lvl->tilesets[i].scale);
+            if (w != lvl->tileSize) {
+                fprintf(stderr, "[Level] WARNING: Tileset %s has a different scaled width (%d vs %d)\n",
+                        lvl->tilesets[i].id, w, lvl->tileSize);
+            }
         }
     }
-    return firstWidth;
+    lvl->pixelWidth = lvl->levelColumns * lvl->tileSize;
+    lvl->pixelHeight = lvl->levelRows * lvl->tileSize;
+
+    return lvl->tileSize > 0;
+}
+
+Tileset *level_getLayerTileset(Level *lvl, const Layer *layer)
+{
+    if (!lvl || !layer || layer->tilesetIndex < 0 || layer->tilesetIndex >= lvl->tilesetCount) return NULL;
+    return &lvl->tilesets[layer->tilesetIndex];
+}
+
+int getLevelTileWidth(Level *lvl) 
+{
+    return lvl ? lvl->tileSize : 0;
 }
 
 bool level_isTileSolid(Level *lvl, int worldX, int worldY) 
 {
     if (!lvl) return false;
 
-    int tileW = getLevelTileWidth(lvl);
+    int tileW = lvl->tileSize;
+    if (tileW <= 0) return false;
     int tileH = tileW; // square tiles
-    int col = worldX / tileW;
-    int row = worldY / tileH;
 
-    // Out of bounds check
+    // Negative coords would round toward zero, treat them as out of bounds
+    if (worldX < 0 || worldY < 0) return false;
+
+    return level_isCellSolid(lvl, worldX / tileW, worldY / tileH);
+}
+
+// Recomputes a single cell of the solid grid from every collidable layer
+static void level_refreshSolidCell(Level *lvl, int col, int row)
+{
+    int cell = row * lvl->levelColumns + col;
+    bool solid = false;
+
+    for (int i = 0; i < lvl->layerCount && !solid; i++) {
+        Layer *layer = &lvl->layers[i];
+        if (!layer->collidable || !layer->tiles) continue;
+        solid = isSolidTileInLayer(layer, layer->tiles[cell]);
+    }
+
+    if (solid) lvl->solidGrid[cell >> 5] |=  (1u << (cell & 31));
+    else       lvl->solidGrid[cell >> 5] &= ~(1u << (cell & 31));
+}
+
+// Builds the merged collision bitset, one bit per cell.
+// Collision queries only ever read this, so their cost doesn't grow with the
+// number of collidable layers or the size of their solidTiles lists.
+bool level_buildSolidGrid(Level *lvl)
+{
+    if (!lvl || lvl->levelRows <= 0 || lvl->levelColumns <= 0) return false;
+
+    int cellCount = lvl->levelRows * lvl->levelColumns;
+    free(lvl->solidGrid);
+    lvl->solidGrid = calloc((cellCount + 31) / 32, sizeof(Uint32));
+    if (!lvl->solidGrid) return false;
+
+    for (int row = 0; row < lvl->levelRows; row++) {
+        for (int col = 0; col < lvl->levelColumns; col++) {
+            level_refreshSolidCell(lvl, col, row);
+        }
+    }
+    return true;
+}
+
+bool level_isCellSolid(const Level *lvl, int col, int row)
+{
+    if (!lvl || !lvl->solidGrid) return false;
     if (col < 0 || col >= lvl->levelColumns ||
         row < 0 || row >= lvl->levelRows) {
         return false;
     }
 
-    // Loop through all layers
-    for (int i = 0; i < lvl->layerCount; i++) {
-        Layer *layer = &lvl->layers[i];
-        if (!layer->collidable) continue;
+    int cell = row * lvl->levelColumns + col;
+    return (lvl->solidGrid[cell >> 5] >> (cell & 31)) & 1u;
+}
 
-        int tileIndex = layer->tiles[row * lvl->levelColumns + col];
-        // Check against solidTiles list
-        for (int s = 0; s < layer->solidCount; s++) {
-            if (tileIndex == layer->solidTiles[s]) {
-                return true; // Found a solid tile
-            }
-        }
+// Changes a tile at runtime (destroyed blocks, switches, ...) and keeps the
+// solid grid in sync for that cell only
+void level_setTile(Level *lvl, int layerIndex, int col, int row, int tileIndex)
+{
+    if (!lvl || layerIndex < 0 || layerIndex >= lvl->layerCount) return;
+    if (col < 0 || col >= lvl->levelColumns ||
+        row < 0 || row >= lvl->levelRows) {
+        return;
     }
 
-    return false;
+    Layer *layer = &lvl->layers[layerIndex];
+    if (!layer->tiles) return;
+
+    layer->tiles[row * lvl->levelColumns + col] = tileIndex;
+    if (layer->collidable && lvl->solidGrid) {
+        level_refreshSolidCell(lvl, col, row);
+    }
+    if (layer->isStatic) {
+        ChunkCache_InvalidateTile(lvl->chunkCache, layerIndex, col, row);
+    }
 }
 
 
@@ -418,40 +875,127 @@ void spawnPlayerOnAnyCollidable(Player *p, int spawnCol, Level *lvl, bool search
 }
 
 
-void renderLayer(Layer *layer, Level *lvl, SDL_Renderer *renderer, int cameraX, int cameraY)
+// Converts a world-space view rect into an inclusive cell range, grown by
+// one tile on every side and clamped to the level. Returns false if nothing is visible.
+static bool level_getVisibleCells(const Level *lvl, const SDL_Rect *view, int tileSize,
+                                  int *firstCol, int *lastCol, int *firstRow, int *lastRow)
 {
-    Tileset *ts = findTileset(lvl, layer->tileset_id);
-    if (!ts || !ts->tex) return;
+    if (!lvl || !view || tileSize <= 0) return false;
+
+    // floor division so a view starting left/above the map still maps correctly
+    int c0 = (view->x >= 0) ? view->x / tileSize : -((-view->x + tileSize - 1) / tileSize);
+    int r0 = (view->y >= 0) ? view->y / tileSize : -((-view->y + tileSize - 1) / tileSize);
+    int c1 = (view->x + view->w) / tileSize;
+    int r1 = (view->y + view->h) / tileSize;
+
+    // one tile border
+    c0 -= 1; r0 -= 1;
+    c1 += 1; r1 += 1;
+
+    if (c0 < 0) c0 = 0;
+    if (r0 < 0) r0 = 0;
+    if (c1 >= lvl->levelColumns) c1 = lvl->levelColumns - 1;
+    if (r1 >= lvl->levelRows) r1 = lvl->levelRows - 1;
+
+    if (c0 > c1 || r0 > r1) return false;
+
+    *firstCol = c0; *lastCol = c1;
+    *firstRow = r0; *lastRow = r1;
+    return true;
+}
 
+// Only walks the cells inside the camera view, so cost scales with screen size, not level size
+static void renderLayerCopy(Layer *layer, Level *lvl, Tileset *ts, SDL_Renderer *renderer, const SDL_Rect *view,
+                            int firstCol, int lastCol, int firstRow, int lastRow)
+{
     // consistent scaled tile size used for pos & size
-    int scaledTile = (int)(ts->tileSize * ts->scale);
+    int scaledTile = layer->scaledTileSize;
+    int drawn = 0;
 
-    for (int r = 0; r < lvl->levelRows; ++r) {
-        for (int c = 0; c < lvl->levelColumns; ++c) {
-            int rawIdx = layer->tiles[r * lvl->levelColumns + c];
+    for (int r = firstRow; r <= lastRow; ++r) {
+        const int *rowTiles = &layer->tiles[r * lvl->levelColumns];
+        for (int c = firstCol; c <= lastCol; ++c) {
+            int rawIdx = rowTiles[c];
 
             // CSV uses -1 for empty -> skip negatives only
             if (rawIdx < 0) continue;
 
-            int localIdx = rawIdx;
+            SDL_Rect src = Tileset_TileRect(ts, rawIdx);
 
-            SDL_Rect src = {
-                (localIdx % ts->tilesPerRow) * ts->tileSize,
-                (localIdx / ts->tilesPerRow) * ts->tileSize,
-                ts->tileSize,
-                ts->tileSize
+            SDL_Rect dst = {
+                c * scaledTile - view->x,
+                r * scaledTile - view->y,
+                scaledTile,
+                scaledTile
             };
 
+            SDL_RenderCopy(renderer, ts->tex, &src, &dst);
+            COUNTER_DRAW(ts->tex);
+            drawn++;
+        }
+    }
+
+    COUNTER_ADD(COUNTER_TILES_VISITED, (lastCol - firstCol + 1) * (lastRow - firstRow + 1));
+    COUNTER_ADD(COUNTER_TILES_DRAWN, drawn);
+}
+
+// Same walk as renderLayerCopy, but every tile goes into one vertex buffer
+// and the whole layer is a single SDL_RenderGeometry call
+static bool renderLayerBatched(Layer *layer, Level *lvl, Tileset *ts, SDL_Renderer *renderer, const SDL_Rect *view,
+                               int firstCol, int lastCol, int firstRow, int lastRow)
+{
+    if (ts->texW <= 0 || ts->texH <= 0) return false;
+
+    TileBatch *batch = &lvl->tileBatch;
+    int maxQuads = (lastCol - firstCol + 1) * (lastRow - firstRow + 1);
+    if (!TileBatch_Reserve(batch, maxQuads)) return false;
+    TileBatch_Clear(batch);
+
+    int scaledTile = layer->scaledTileSize;
+    float invTexW = 1.0f / ts->texW;
+    float invTexH = 1.0f / ts->texH;
+
+    for (int r = firstRow; r <= lastRow; ++r) {
+        const int *rowTiles = &layer->tiles[r * lvl->levelColumns];
+        for (int c = firstCol; c <= lastCol; ++c) {
+            int rawIdx = rowTiles[c];
+            if (rawIdx < 0) continue;
+
+            SDL_Rect src = Tileset_TileRect(ts, rawIdx);
+
             SDL_Rect dst = {
-                c * scaledTile - cameraX,
-                r * scaledTile - cameraY,
+                c * scaledTile - view->x,
+                r * scaledTile - view->y,
                 scaledTile,
                 scaledTile
             };
 
-            SDL_RenderCopy(renderer, ts->tex, &src, &dst);
+            TileBatch_AddQuad(batch, &src, &dst, invTexW, invTexH);
         }
     }
+
+    COUNTER_ADD(COUNTER_TILES_VISITED, maxQuads);
+    COUNTER_ADD(COUNTER_TILES_DRAWN, batch->quadCount);
+
+    return TileBatch_Flush(batch, renderer, ts->tex);
+}
+
+// Renders the visible part of a layer. With batched set it tries the SDL_RenderGeometry path first;
+// returns false if that failed (the layer is still drawn, through SDL_RenderCopy) so the caller can stop batching.
+bool renderLayer(Layer *layer, Level *lvl, SDL_Renderer *renderer, const SDL_Rect *view, bool batched)
+{
+    Tileset *ts = level_getLayerTileset(lvl, layer);
+    if (!ts || !ts->tex) return true;
+
+    int firstCol, lastCol, firstRow, lastRow;
+    if (!level_getVisibleCells(lvl, view, layer->scaledTileSize, &firstCol, &lastCol, &firstRow, &lastRow)) return true;
+
+    if (batched && renderLayerBatched(layer, lvl, ts, renderer, view, firstCol, lastCol, firstRow, lastRow)) {
+        return true;
+    }
+
+    renderLayerCopy(layer, lvl, ts, renderer, view, firstCol, lastCol, firstRow, lastRow);
+    return !batched;
 }
 
 
@@ -490,19 +1034,32 @@ void renderBackgrounds(Level *lvl, SDL_Renderer *renderer, int cameraX, int came
                 destRect.h = settings->video.height;
 
                 SDL_RenderCopy(renderer, bg->tex, NULL, &destRect);
+                COUNTER_DRAW(bg->tex);
             }
         }
     }
 }
 
 // Render a level: backgrounds first, then tile layers
-void renderLevel(GameManager *gm)
+void renderLevel(GameManager *gm, const Camera *camera)
 {
     //Render all background layers
-    renderBackgrounds(gm->level, gm->mainSystems.renderer, gm->camera.x, 
-        gm->camera.y, &gm->settings);
+    PROFILE_BEGIN("Backgrounds");
+    renderBackgrounds(gm->level, gm->mainSystems.renderer, camera->x, 
+        camera->y, &gm->settings);
+    PROFILE_END();
+
+    SDL_Rect view = Camera_GetViewRect(camera);
+
+    if (!gm->level->chunkCache && gm->settings.video.chunkCacheMB > 0) {
+        gm->level->chunkCache = ChunkCache_Create(gm->level, gm->mainSystems.renderer,
+                                                  (size_t)gm->settings.video.chunkCacheMB * 1024 * 1024);
+        // don't retry every frame if render targets aren't available
+        if (!gm->level->chunkCache) gm->settings.video.chunkCacheMB = 0;
+    }
 
     //Loop through all tile layers
+    PROFILE_BEGIN("Tile layers");
     for (int i = 0; i < gm->level->layerCount; i++) 
     {
         Layer *layer = &gm->level->layers[i];
@@ -510,12 +1067,19 @@ void renderLevel(GameManager *gm)
         //Skip if layer has no tiles
         if (!layer->tiles) continue;
 
-        renderLayer(layer, gm->level, gm->mainSystems.renderer, gm->camera.x, gm->camera.y);
+        if (layer->isStatic && gm->level->chunkCache) {
+            ChunkCache_RenderLayer(gm->level->chunkCache, gm->level, i, gm->mainSystems.renderer, &view);
+        }
+        else if (!renderLayer(layer, gm->level, gm->mainSystems.renderer, &view, gm->settings.video.batchTiles)) {
+            fprintf(stderr, "[Level] Tile batching failed, falling back to SDL_RenderCopy\n");
+            gm->settings.video.batchTiles = false;
+        }
         if (gm->settings.gameplay.debugMode && layer->collidable) 
         {
-            debug_draw_collidable_tiles(gm->level, gm->mainSystems.renderer, gm->camera.x, gm->camera.y);
+            debug_draw_collidable_tiles(gm->level, gm->mainSystems.renderer, camera->x, camera->y);
         }
     }
+    PROFILE_END();
 
 }
 
@@ -526,7 +1090,7 @@ void debug_draw_collidable_tiles(Level *lvl, SDL_Renderer *renderer, int cameraX
 
     // Use *level* tile width for collision grid visualisation.
     // NOTE: If different layers use different tile sizes, consider per-layer scaledTile.
-    int commonTileW = getLevelTileWidth(lvl);
+    int commonTileW = lvl->tileSize;
     if (commonTileW == 0) return;
 
     // Draw grid lines (optional)
@@ -549,10 +1113,8 @@ void debug_draw_collidable_tiles(Level *lvl, SDL_Renderer *renderer, int cameraX
         Layer *layer = &lvl->layers[li];
         if (!layer->collidable) continue;
 
-        // get the tileset for this layer, to compute actual render positions
-        Tileset *ts = findTileset(lvl, layer->tileset_id);
-        int tileW = commonTileW;
-        if (ts) tileW = (int)(ts->tileSize * ts->scale);
+        // the layer's own tile size, to compute actual render positions
+        int tileW = layer->scaledTileSize > 0 ? layer->scaledTileSize : commonTileW;
 
         for (int r = 0; r < lvl->levelRows; ++r) 
         {
@@ -580,15 +1142,29 @@ void unloadLevel(Level *level)
 {
     if (!level) return;
 
+    // Chunk and atlas textures go before the tileset textures they were drawn from are released
+    ChunkCache_Destroy(level->chunkCache);
+    level->chunkCache = NULL;
+    TextureAtlas_Destroy(level->atlas);
+    level->atlas = NULL;
+
     // Free tilesets
     for (int i = 0; i < level->tilesetCount; i++) {
         free(level->tilesets[i].id);
         level->tilesets[i].id = NULL;
-
-        if (level->tilesets[i].tex) {
+        free(level->tilesets[i].imagePath);
+        level->tilesets[i].imagePath = NULL;
+
+        // Without a handle the texture was still being uploaded and belongs to the level
+        if (level->tilesets[i].handle) {
+            TextureCache_Release(level->tilesets[i].handle);
+            level->tilesets[i].handle = NULL;
+        } else if (level->tilesets[i].tex) {
             SDL_DestroyTexture(level->tilesets[i].tex);
-            level->tilesets[i].tex = NULL;
         }
+        level->tilesets[i].tex = NULL;
+        SDL_FreeSurface(level->tilesets[i].staged.surf);
+        level->tilesets[i].staged.surf = NULL;
     }
     free(level->tilesets);
     level->tilesets = NULL;
@@ -598,20 +1174,33 @@ void unloadLevel(Level *level)
     for (int i = 0; i < level->layerCount; i++) {
         free(level->layers[i].csvPath);
         free(level->layers[i].tileset_id);
-        free(level->layers[i].tiles);
-        free(level->layers[i].solidTiles);
+        // tiles and solid sets of a compiled level live inside the file mapping
+        if (!level->mapping) {
+            free(level->layers[i].tiles);
+            free(level->layers[i].solidTiles);
+        }
     }
     free(level->layers);
     level->layers = NULL;
     level->layerCount = 0;
 
+    free(level->solidGrid);
+    level->solidGrid = NULL;
+
+    TileBatch_Free(&level->tileBatch);
+
     // Free background layers
     for (int i = 0; i < level->bgCount; i++) {
         free(level->bgs[i].imagePath);
-        if (level->bgs[i].tex) {
+        if (level->bgs[i].handle) {
+            TextureCache_Release(level->bgs[i].handle);
+            level->bgs[i].handle = NULL;
+        } else if (level->bgs[i].tex) {
             SDL_DestroyTexture(level->bgs[i].tex);
-            level->bgs[i].tex = NULL;
         }
+        level->bgs[i].tex = NULL;
+        SDL_FreeSurface(level->bgs[i].staged.surf);
+        level->bgs[i].staged.surf = NULL;
     }
     free(level->bgs);
     level->bgs = NULL;
@@ -620,6 +1209,11 @@ void unloadLevel(Level *level)
     // Free level name
     free(level->name);
     level->name = NULL;
+    free(level->nextLevel);
+    level->nextLevel = NULL;
+
+    LevelBin_Unmap(level->mapping);
+    level->mapping = NULL;
 }
 
         
\ No newline at end of file
@@ -0,0 +1,406 @@
+#include "levelBin.h"
+#include "level.h"
+#include "counters.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+struct LevelBinMapping {
+    void *data;
+    size_t size;
+};
+
+#define LEVELBIN_ALIGN(x, a) (((x) + ((a) - 1)) & ~(size_t)((a) - 1))
+
+// "maps/foo/foo.json" -> "maps/foo/foo.lvlbin"
+bool LevelBin_PathFor(const char *jsonPath, char *out, size_t outSize)
+{
+    if (!jsonPath || !out) return false;
+
+    const char *dot = strrchr(jsonPath, '.');
+    const char *slash = strrchr(jsonPath, '/');
+    const char *backslash = strrchr(jsonPath, '\\');
+    if (backslash > slash) slash = backslash;
+    size_t stem = (dot && dot > slash) ? (size_t)(dot - jsonPath) : strlen(jsonPath);
+
+    if (stem + strlen(LEVELBIN_EXT) + 1 > outSize) return false;
+    memcpy(out, jsonPath, stem);
+    strcpy(out + stem, LEVELBIN_EXT);
+    return true;
+}
+
+static bool LevelBin_NewerOrEqual(const char *a, const char *b)
+{
+    struct stat sa, sb;
+    if (stat(a, &sa) != 0) return false;
+    if (stat(b, &sb) != 0) return true;     // nothing to compare against, the binary is all we have
+    return sa.st_mtime >= sb.st_mtime;
+}
+
+// A compiled level is only used if it exists and isn't older than its JSON
+bool LevelBin_IsFresh(const char *binPath, const char *jsonPath)
+{
+    struct stat st;
+    if (stat(binPath, &st) != 0) return false;
+
+    if (!LevelBin_NewerOrEqual(binPath, jsonPath)) {
+        fprintf(stderr, "[LevelBin] %s is older than %s, ignoring it (recompile the level)\n", binPath, jsonPath);
+        return false;
+    }
+    return true;
+}
+
+// String table builder for the writer
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+} LevelBinStrings;
+
+static Uint32 LevelBin_AddString(LevelBinStrings *st, const char *str)
+{
+    if (!str) str = "";
+    size_t len = strlen(str) + 1;
+    if (st->size + len > st->capacity) {
+        size_t cap = st->capacity ? st->capacity : 256;
+        while (cap < st->size + len) cap *= 2;
+        char *grown = realloc(st->data, cap);
+        if (!grown) return 0;
+        st->data = grown;
+        st->capacity = cap;
+    }
+    Uint32 offset = (Uint32)st->size;
+    memcpy(st->data + st->size, str, len);
+    st->size += len;
+    return offset;
+}
+
+bool LevelBin_Write(const Level *lvl, const char *binPath)
+{
+    if (!lvl || !binPath) return false;
+
+    size_t cells = (size_t)lvl->levelRows * lvl->levelColumns;
+
+    LevelBinHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = LEVELBIN_MAGIC;
+    header.version = LEVELBIN_VERSION;
+    header.levelRows = lvl->levelRows;
+    header.levelColumns = lvl->levelColumns;
+    header.spawnColumn = lvl->spawnColumn;
+    header.tilesetCount = lvl->tilesetCount;
+    header.layerCount = lvl->layerCount;
+    header.bgCount = lvl->bgCount;
+
+    LevelBinTileset *tilesets = calloc(lvl->tilesetCount + 1, sizeof(LevelBinTileset));
+    LevelBinLayer *layers = calloc(lvl->layerCount + 1, sizeof(LevelBinLayer));
+    LevelBinBackground *bgs = calloc(lvl->bgCount + 1, sizeof(LevelBinBackground));
+    LevelBinStrings strings = { 0 };
+    if (!tilesets || !layers || !bgs) {
+        free(tilesets); free(layers); free(bgs);
+        return false;
+    }
+
+    header.name = LevelBin_AddString(&strings, lvl->name);
+    header.nextLevel = LevelBin_AddString(&strings, lvl->nextLevel);
+
+    for (int i = 0; i < lvl->tilesetCount; i++) {
+        const Tileset *ts = &lvl->tilesets[i];
+        tilesets[i].id = LevelBin_AddString(&strings, ts->id);
+        tilesets[i].image = LevelBin_AddString(&strings, ts->imagePath);
+        tilesets[i].tileSize = ts->tileSize;
+        tilesets[i].tilesPerRow = ts->tilesPerRow;
+        tilesets[i].scale = ts->scale;
+    }
+
+    for (int i = 0; i < lvl->bgCount; i++) {
+        const BackgroundLayer *bg = &lvl->bgs[i];
+        bgs[i].image = LevelBin_AddString(&strings, bg->imagePath);
+        bgs[i].scrollSpeed = bg->scrollSpeed;
+        bgs[i].scale = bg->scale;
+        bgs[i].offsetY = bg->offsetY;
+    }
+
+    for (int i = 0; i < lvl->layerCount; i++) {
+        const Layer *layer = &lvl->layers[i];
+        layers[i].csvPath = LevelBin_AddString(&strings, layer->csvPath);
+        layers[i].tilesetId = LevelBin_AddString(&strings, layer->tileset_id);
+        layers[i].flags = (layer->collidable ? LEVELBIN_LAYER_COLLIDABLE : 0) |
+                          (layer->isStatic ? LEVELBIN_LAYER_STATIC : 0);
+        layers[i].solidCount = layer->solidCount;
+    }
+
+    // Layout
+    size_t offset = sizeof(LevelBinHeader);
+    header.tilesetOffset = (Uint32)offset;
+    offset += sizeof(LevelBinTileset) * lvl->tilesetCount;
+    header.layerOffset = (Uint32)offset;
+    offset += sizeof(LevelBinLayer) * lvl->layerCount;
+    header.bgOffset = (Uint32)offset;
+    offset += sizeof(LevelBinBackground) * lvl->bgCount;
+    header.stringsOffset = (Uint32)offset;
+    header.stringsSize = (Uint32)strings.size;
+    offset += strings.size;
+
+    for (int i = 0; i < lvl->layerCount; i++) {
+        offset = LEVELBIN_ALIGN(offset, 4);
+        layers[i].solidOffset = (Uint32)offset;
+        offset += sizeof(Sint32) * layers[i].solidCount;
+    }
+    for (int i = 0; i < lvl->layerCount; i++) {
+        offset = LEVELBIN_ALIGN(offset, 16);
+        layers[i].tilesOffset = (Uint32)offset;
+        offset += sizeof(Sint32) * cells;
+    }
+    header.fileSize = (Uint32)offset;
+
+    // Assemble in memory, then one write
+    char *file = calloc(1, offset);
+    if (!file) {
+        free(tilesets); free(layers); free(bgs); free(strings.data);
+        return false;
+    }
+
+    memcpy(file, &header, sizeof(header));
+    memcpy(file + header.tilesetOffset, tilesets, sizeof(LevelBinTileset) * lvl->tilesetCount);
+    memcpy(file + header.layerOffset, layers, sizeof(LevelBinLayer) * lvl->layerCount);
+    memcpy(file + header.bgOffset, bgs, sizeof(LevelBinBackground) * lvl->bgCount);
+    if (strings.size) memcpy(file + header.stringsOffset, strings.data, strings.size);
+
+    for (int i = 0; i < lvl->layerCount; i++) {
+        const Layer *layer = &lvl->layers[i];
+        Sint32 *solid = (Sint32 *)(file + layers[i].solidOffset);
+        for (int s = 0; s < layer->solidCount; s++) solid[s] = layer->solidTiles[s];
+
+        Sint32 *tiles = (Sint32 *)(file + layers[i].tilesOffset);
+        for (size_t c = 0; c < cells; c++) tiles[c] = layer->tiles ? layer->tiles[c] : -1;
+    }
+
+    bool ok = false;
+    FILE *f = fopen(binPath, "wb");
+    if (f) {
+        ok = fwrite(file, 1, offset, f) == offset;
+        ok = (fclose(f) == 0) && ok;
+    }
+    if (!ok) {
+        fprintf(stderr, "[LevelBin] ERROR: Failed to write %s\n", binPath);
+    }
+
+    free(file);
+    free(tilesets);
+    free(layers);
+    free(bgs);
+    free(strings.data);
+    return ok;
+}
+
+// Maps the whole file copy-on-write, so level_setTile can edit tiles without touching the file
+static LevelBinMapping *LevelBin_Map(const char *binPath)
+{
+    LevelBinMapping *mapping = calloc(1, sizeof(LevelBinMapping));
+    if (!mapping) return NULL;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(binPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) { free(mapping); return NULL; }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) { CloseHandle(file); free(mapping); return NULL; }
+
+    HANDLE section = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!section) { free(mapping); return NULL; }
+
+    mapping->data = MapViewOfFile(section, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(section);   // the view keeps the section alive
+    if (!mapping->data) { free(mapping); return NULL; }
+    mapping->size = (size_t)size.QuadPart;
+#else
+    int fd = open(binPath, O_RDONLY);
+    if (fd < 0) { free(mapping); return NULL; }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); free(mapping); return NULL; }
+
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) { free(mapping); return NULL; }
+    mapping->data = data;
+    mapping->size = (size_t)st.st_size;
+#endif
+
+    return mapping;
+}
+
+void LevelBin_Unmap(LevelBinMapping *mapping)
+{
+    if (!mapping) return;
+#ifdef _WIN32
+    UnmapViewOfFile(mapping->data);
+#else
+    munmap(mapping->data, mapping->size);
+#endif
+    free(mapping);
+}
+
+static bool LevelBin_RangeOk(const LevelBinMapping *m, Uint32 offset, size_t bytes)
+{
+    return offset <= m->size && bytes <= m->size - offset;
+}
+
+static const char *LevelBin_String(const LevelBinMapping *m, const LevelBinHeader *h, Uint32 offset)
+{
+    if (offset >= h->stringsSize) return NULL;
+    const char *str = (const char *)m->data + h->stringsOffset + offset;
+    // must be terminated inside the table
+    if (!memchr(str, '\0', h->stringsSize - offset)) return NULL;
+    return str;
+}
+
+static char *LevelBin_DupString(const LevelBinMapping *m, const LevelBinHeader *h, Uint32 offset)
+{
+    const char *str = LevelBin_String(m, h, offset);
+    return str ? _strdup(str) : NULL;
+}
+
+// Loads a compiled level. Tile arrays and solid sets aren't copied, they point into the mapping.
+// Returns NULL (and the caller falls back to JSON) on any mismatch.
+Level *LevelBin_Load(const char *binPath)
+{
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    // Files are written little-endian and mapped as-is
+    return NULL;
+#else
+    LevelBinMapping *m = LevelBin_Map(binPath);
+    if (!m) return NULL;
+    COUNTER_ADD(COUNTER_BYTES_READ, m->size);
+
+    const char *base = (const char *)m->data;
+    const LevelBinHeader *h = (const LevelBinHeader *)base;
+
+    if (m->size < sizeof(LevelBinHeader) || h->magic != LEVELBIN_MAGIC || h->version != LEVELBIN_VERSION ||
+        h->fileSize != m->size || h->levelRows <= 0 || h->levelColumns <= 0 ||
+        !LevelBin_RangeOk(m, h->tilesetOffset, sizeof(LevelBinTileset) * (size_t)h->tilesetCount) ||
+        !LevelBin_RangeOk(m, h->layerOffset, sizeof(LevelBinLayer) * (size_t)h->layerCount) ||
+        !LevelBin_RangeOk(m, h->bgOffset, sizeof(LevelBinBackground) * (size_t)h->bgCount) ||
+        !LevelBin_RangeOk(m, h->stringsOffset, h->stringsSize)) {
+        fprintf(stderr, "[LevelBin] %s is not a valid compiled level (version %u expected)\n", binPath, LEVELBIN_VERSION);
+        LevelBin_Unmap(m);
+        return NULL;
+    }
+
+    size_t cells = (size_t)h->levelRows * h->levelColumns;
+    const LevelBinTileset *tilesets = (const LevelBinTileset *)(base + h->tilesetOffset);
+    const LevelBinLayer *layers = (const LevelBinLayer *)(base + h->layerOffset);
+    const LevelBinBackground *bgs = (const LevelBinBackground *)(base + h->bgOffset);
+
+    // Tile sizes divide and scale every draw, a bad one sends us back to the JSON
+    for (Uint32 i = 0; i < h->tilesetCount; i++) {
+        if (tilesets[i].tileSize <= 0 || tilesets[i].tilesPerRow <= 0 ||
+            !(isfinite(tilesets[i].scale) && tilesets[i].scale > 0.0f)) {
+            fprintf(stderr, "[LevelBin] %s: tileset %u has an invalid size or scale\n", binPath, i);
+            LevelBin_Unmap(m);
+            return NULL;
+        }
+    }
+
+    for (Uint32 i = 0; i < h->layerCount; i++) {
+        if (layers[i].tilesOffset % 16 != 0 || layers[i].solidOffset % 4 != 0 ||
+            !LevelBin_RangeOk(m, layers[i].tilesOffset, sizeof(Sint32) * cells) ||
+            !LevelBin_RangeOk(m, layers[i].solidOffset, sizeof(Sint32) * (size_t)layers[i].solidCount)) {
+            fprintf(stderr, "[LevelBin] %s: layer %u is out of range\n", binPath, i);
+            LevelBin_Unmap(m);
+            return NULL;
+        }
+
+        // The CSVs are the source of truth, recompile if one was edited after the binary
+        const char *csv = LevelBin_String(m, h, layers[i].csvPath);
+        if (csv && !LevelBin_NewerOrEqual(binPath, csv)) {
+            fprintf(stderr, "[LevelBin] %s is older than %s, ignoring it (recompile the level)\n", binPath, csv);
+            LevelBin_Unmap(m);
+            return NULL;
+        }
+    }
+
+    fprintf(stderr, "[Level] Loading compiled level: %s\n", binPath);
+
+    Level *lvl = calloc(1, sizeof(Level));
+    if (!lvl) { LevelBin_Unmap(m); return NULL; }
+
+    lvl->mapping = m;
+    lvl->name = LevelBin_DupString(m, h, h->name);
+    if (!lvl->name) lvl->name = _strdup("UNKNOWN");
+    const char *next = LevelBin_String(m, h, h->nextLevel);
+    if (next && next[0]) lvl->nextLevel = _strdup(next);
+    lvl->levelRows = h->levelRows;
+    lvl->levelColumns = h->levelColumns;
+    lvl->spawnColumn = h->spawnColumn;
+
+    lvl->tilesets = calloc(h->tilesetCount, sizeof(Tileset));
+    lvl->layers = calloc(h->layerCount, sizeof(Layer));
+    lvl->bgs = calloc(h->bgCount, sizeof(BackgroundLayer));
+    lvl->tilesetCount = h->tilesetCount;
+    lvl->layerCount = h->layerCount;
+    lvl->bgCount = h->bgCount;
+    if ((h->tilesetCount && !lvl->tilesets) || (h->layerCount && !lvl->layers) || (h->bgCount && !lvl->bgs)) {
+        unloadLevel(lvl);   // also unmaps the file
+        free(lvl);
+        return NULL;
+    }
+
+    // Ids and image paths are looked up and opened later, a bad string offset makes the file invalid
+    bool stringsOk = true;
+
+    for (Uint32 i = 0; i < h->tilesetCount; i++) {
+        Tileset *ts = &lvl->tilesets[i];
+        ts->id = LevelBin_DupString(m, h, tilesets[i].id);
+        ts->imagePath = LevelBin_DupString(m, h, tilesets[i].image);
+        ts->tileSize = tilesets[i].tileSize;
+        ts->tilesPerRow = tilesets[i].tilesPerRow;
+        ts->scale = tilesets[i].scale;
+        if (!ts->id || !ts->imagePath) stringsOk = false;
+    }
+
+    for (Uint32 i = 0; i < h->layerCount; i++) {
+        Layer *layer = &lvl->layers[i];
+        layer->csvPath = LevelBin_DupString(m, h, layers[i].csvPath);
+        layer->tileset_id = LevelBin_DupString(m, h, layers[i].tilesetId);
+        layer->collidable = (layers[i].flags & LEVELBIN_LAYER_COLLIDABLE) != 0;
+        layer->isStatic = (layers[i].flags & LEVELBIN_LAYER_STATIC) != 0;
+        layer->solidCount = (int)layers[i].solidCount;
+        layer->solidTiles = layer->solidCount ? (int *)(base + layers[i].solidOffset) : NULL;
+        layer->tiles = (int *)(base + layers[i].tilesOffset);
+        if (!layer->tileset_id) stringsOk = false;
+    }
+
+    for (Uint32 i = 0; i < h->bgCount; i++) {
+        BackgroundLayer *bg = &lvl->bgs[i];
+        bg->imagePath = LevelBin_DupString(m, h, bgs[i].image);
+        bg->scrollSpeed = bgs[i].scrollSpeed;
+        bg->scale = bgs[i].scale;
+        bg->offsetY = bgs[i].offsetY;
+        if (!bg->imagePath) stringsOk = false;
+    }
+
+    if (!stringsOk) {
+        fprintf(stderr, "[LevelBin] %s has a bad string reference, not a valid compiled level\n", binPath);
+        unloadLevel(lvl);
+        free(lvl);
+        return NULL;
+    }
+
+    return lvl;
+#endif
+}
@@ -0,0 +1,204 @@
+#include "levelLoader.h"
+#include "level.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+LevelLoader *LevelLoader_Create(TextureCache *textures)
+{
+    LevelLoader *loader = calloc(1, sizeof(LevelLoader));
+    if (!loader) return NULL;
+    loader->textures = textures;
+    return loader;
+}
+
+static void LevelLoader_Reset(LevelLoader *loader)
+{
+    if (loader->level) {
+        unloadLevel(loader->level);
+        free(loader->level);
+        loader->level = NULL;
+    }
+    free(loader->levelName);
+    loader->levelName = NULL;
+    free(loader->jsonPath);
+    loader->jsonPath = NULL;
+    loader->state = LEVELLOAD_IDLE;
+    loader->dropCap = false;
+}
+
+void LevelLoader_Destroy(LevelLoader *loader)
+{
+    if (!loader) return;
+
+    // The thread can't be interrupted mid-parse, let it finish and throw the result away
+    if (loader->thread) {
+        SDL_WaitThread(loader->thread, NULL);
+        loader->thread = NULL;
+    }
+    LevelLoader_Reset(loader);
+    free(loader);
+}
+
+static int LevelLoader_Thread(void *data)
+{
+    LevelLoader *loader = data;
+    loader->level = level_loadStaged(loader->jsonPath, loader->textures, loader->capBytes);
+    SDL_AtomicSet(&loader->workerDone, 1);
+    return 0;
+}
+
+static bool LevelLoader_Spawn(LevelLoader *loader)
+{
+    SDL_AtomicSet(&loader->workerDone, 0);
+    loader->state = LEVELLOAD_WORKING;
+
+    loader->thread = SDL_CreateThread(LevelLoader_Thread, "LevelLoader", loader);
+    if (!loader->thread) {
+        fprintf(stderr, "[LevelLoader] Failed to start loader thread: %s\n", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+bool LevelLoader_Start(LevelLoader *loader, const char *levelName, const char *jsonPath)
+{
+    if (!loader || !levelName || !jsonPath) return false;
+
+    if (LevelLoader_IsBusy(loader)) {
+        fprintf(stderr, "[LevelLoader] Already loading '%s', ignoring '%s'\n", loader->levelName, levelName);
+        return false;
+    }
+    LevelLoader_Reset(loader);
+
+    loader->levelName = _strdup(levelName);
+    loader->jsonPath = _strdup(jsonPath);
+    if (!loader->levelName || !loader->jsonPath) {
+        LevelLoader_Reset(loader);
+        return false;
+    }
+
+    loader->startCounter = SDL_GetPerformanceCounter();
+    if (!LevelLoader_Spawn(loader)) {
+        LevelLoader_Reset(loader);
+        return false;
+    }
+
+    fprintf(stderr, "[LevelLoader] Loading '%s' in the background\n", levelName);
+    return true;
+}
+
+// Picks up the thread's result without uploading anything. A loader left in
+// LEVELLOAD_UPLOADING holds a fully staged level, which is what the prefetcher keeps around.
+LevelLoadState LevelLoader_Poll(LevelLoader *loader)
+{
+    if (!loader) return LEVELLOAD_IDLE;
+
+    if (loader->state == LEVELLOAD_WORKING) {
+        if (!SDL_AtomicGet(&loader->workerDone)) return loader->state;
+
+        // Joining also makes everything the thread wrote visible here
+        SDL_WaitThread(loader->thread, NULL);
+        loader->thread = NULL;
+
+        // The thread read the cap when it started, it can only be dropped now that it's done
+        if (loader->dropCap) {
+            bool retry = !loader->level && loader->capBytes;
+            loader->dropCap = false;
+            loader->capBytes = 0;
+            if (retry) {
+                fprintf(stderr, "[LevelLoader] Loading '%s' again without the prefetch cap\n", loader->levelName);
+                if (LevelLoader_Spawn(loader)) return loader->state;
+            }
+        }
+
+        if (!loader->level) {
+            fprintf(stderr, "[LevelLoader] ERROR: Failed to load '%s'\n", loader->levelName);
+            loader->state = LEVELLOAD_FAILED;
+            return loader->state;
+        }
+        loader->state = LEVELLOAD_UPLOADING;
+    }
+
+    return loader->state;
+}
+
+// Call once per frame on the main thread. budgetMs caps the time spent creating
+// textures this frame, 0 or less uploads everything at once.
+LevelLoadState LevelLoader_Update(LevelLoader *loader, float budgetMs)
+{
+    if (!loader) return LEVELLOAD_IDLE;
+
+    if (LevelLoader_Poll(loader) == LEVELLOAD_UPLOADING) {
+        Uint64 deadline = 0;
+        if (budgetMs > 0.0f) {
+            deadline = SDL_GetPerformanceCounter() + (Uint64)(budgetMs * 0.001 * SDL_GetPerformanceFrequency());
+        }
+
+        bool done = false;
+        if (!level_uploadTextures(loader->level, loader->textures, deadline, &done)) {
+            fprintf(stderr, "[LevelLoader] ERROR: Failed to create textures for '%s'\n", loader->levelName);
+            unloadLevel(loader->level);
+            free(loader->level);
+            loader->level = NULL;
+            loader->state = LEVELLOAD_FAILED;
+            return loader->state;
+        }
+
+        if (done) {
+            double ms = (SDL_GetPerformanceCounter() - loader->startCounter) * 1000.0 / SDL_GetPerformanceFrequency();
+            fprintf(stderr, "[LevelLoader] '%s' ready after %.1f ms\n", loader->levelName, ms);
+            loader->state = LEVELLOAD_READY;
+        }
+    }
+
+    return loader->state;
+}
+
+// Hands over the finished level (NULL after a failure) and its name, both owned by
+// the caller from here on. The loader is idle again afterwards.
+Level *LevelLoader_Take(LevelLoader *loader, char **levelName)
+{
+    if (!loader || loader->state == LEVELLOAD_WORKING || loader->state == LEVELLOAD_UPLOADING) return NULL;
+
+    Level *lvl = loader->state == LEVELLOAD_READY ? loader->level : NULL;
+    if (lvl) loader->level = NULL;
+
+    if (levelName) {
+        *levelName = loader->levelName;
+        loader->levelName = NULL;
+    }
+
+    LevelLoader_Reset(loader);
+    return lvl;
+}
+
+// Blocks until the thread is done, uploads everything left in one go and hands the level
+// over like LevelLoader_Take. For synchronous loads that pick up a staged level.
+Level *LevelLoader_Finish(LevelLoader *loader, char **levelName)
+{
+    if (!loader) return NULL;
+
+    // Polling may start the thread again (see dropCap), so wait until it stays done
+    while (loader->state == LEVELLOAD_WORKING) {
+        SDL_WaitThread(loader->thread, NULL);
+        loader->thread = NULL;
+        LevelLoader_Update(loader, 0.0f);
+    }
+    LevelLoader_Update(loader, 0.0f);
+    return LevelLoader_Take(loader, levelName);
+}
+
+// Throws away whatever the loader holds. Fails while the thread is still running.
+bool LevelLoader_Discard(LevelLoader *loader)
+{
+    if (!loader || LevelLoader_Poll(loader) == LEVELLOAD_WORKING) return false;
+    LevelLoader_Reset(loader);
+    return true;
+}
+
+bool LevelLoader_IsBusy(const LevelLoader *loader)
+{
+    return loader && (loader->state == LEVELLOAD_WORKING || loader->state == LEVELLOAD_UPLOADING);
+}
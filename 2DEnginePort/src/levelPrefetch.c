@@ -0,0 +1,95 @@
+#include "levelPrefetch.h"
+#include "levelLoader.h"
+#include "level.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+LevelPrefetcher *LevelPrefetcher_Create(size_t capBytes, TextureCache *textures)
+{
+    LevelPrefetcher *pf = calloc(1, sizeof(LevelPrefetcher));
+    if (!pf) return NULL;
+
+    pf->loader = LevelLoader_Create(textures);
+    if (!pf->loader) {
+        free(pf);
+        return NULL;
+    }
+    pf->capBytes = capBytes;
+    pf->loader->capBytes = capBytes;
+    return pf;
+}
+
+void LevelPrefetcher_Destroy(LevelPrefetcher *pf)
+{
+    if (!pf) return;
+    LevelLoader_Destroy(pf->loader);
+    free(pf->target);
+    free(pf);
+}
+
+static bool LevelPrefetcher_Holds(const LevelPrefetcher *pf, const char *levelName)
+{
+    return pf->loader->levelName && strcmp(pf->loader->levelName, levelName) == 0;
+}
+
+// Call when the frame has nothing else loading. Starts staging levelName if it isn't
+// already. The loader stops on its own once the level is known to be bigger than the
+// cap, so an oversized level is never fully staged; it just fails and isn't retried.
+void LevelPrefetcher_Update(LevelPrefetcher *pf, const char *levelName, const char *jsonPath)
+{
+    if (!pf || pf->capBytes == 0) return;
+
+    LevelLoadState state = LevelLoader_Poll(pf->loader);
+    if (state == LEVELLOAD_WORKING) return;
+
+    if (state == LEVELLOAD_UPLOADING && pf->stagedBytes == 0) {
+        pf->stagedBytes = level_stagedBytes(pf->loader->level);
+        fprintf(stderr, "[Prefetch] Staged '%s' (%zu KB)\n", pf->loader->levelName, pf->stagedBytes / 1024);
+        return;
+    }
+    if (state == LEVELLOAD_FAILED) {
+        LevelLoader_Discard(pf->loader);
+        return;
+    }
+
+    if (!levelName || !jsonPath) return;
+    if (pf->target && strcmp(pf->target, levelName) == 0) return;
+
+    // The guess changed, whatever is staged now is for the wrong level
+    if (!LevelPrefetcher_Holds(pf, levelName)) {
+        LevelLoader_Discard(pf->loader);
+        pf->stagedBytes = 0;
+    }
+
+    free(pf->target);
+    pf->target = _strdup(levelName);
+    LevelLoader_Start(pf->loader, levelName, jsonPath);
+}
+
+// If levelName is staged (or still being staged) hands over its loader and keeps the
+// idle `spare` in its place. Returns NULL when the prefetcher has nothing for that level.
+LevelLoader *LevelPrefetcher_Claim(LevelPrefetcher *pf, const char *levelName, LevelLoader *spare)
+{
+    if (!pf || !levelName || !spare || LevelLoader_IsBusy(spare)) return NULL;
+    LevelLoader_Poll(pf->loader);
+    if (!LevelLoader_IsBusy(pf->loader) || !LevelPrefetcher_Holds(pf, levelName)) return NULL;
+
+    // The cap is for prefetching, not for loads the game asked for. A thread still
+    // staging keeps the cap it started with; the loader drops it when the thread is done.
+    LevelLoader *staged = pf->loader;
+    staged->startCounter = SDL_GetPerformanceCounter();
+    if (staged->state == LEVELLOAD_WORKING) staged->dropCap = true;
+    else staged->capBytes = 0;
+
+    LevelLoader_Discard(spare);
+    spare->capBytes = pf->capBytes;
+    pf->loader = spare;
+    pf->stagedBytes = 0;
+    free(pf->target);
+    pf->target = NULL;
+
+    fprintf(stderr, "[Prefetch] Using staged data for '%s'\n", levelName);
+    return staged;
+}
@@ -0,0 +1,282 @@
+#include "physicsWorld.h"
+#include "jobSystem.h"
+#include "counters.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static Uint32 PhysicsWorld_Generation(BodyHandle handle)
+{
+    return handle >> PHYSICS_INDEX_BITS;
+}
+
+static bool PhysicsWorld_GrowBodies(PhysicsWorld *world, int capacity)
+{
+    // Each array is grown in place, the ones already grown just have spare room if a later one fails
+    float **floats[] = { &world->x, &world->y, &world->vx, &world->vy, &world->w, &world->h,
+                         &world->gravity, &world->maxFallSpeed };
+    for (int i = 0; i < (int)SDL_arraysize(floats); i++) {
+        float *grown = realloc(*floats[i], capacity * sizeof(float));
+        if (!grown) return false;
+        *floats[i] = grown;
+    }
+
+    Uint8 *flags = realloc(world->flags, capacity * sizeof(Uint8));
+    if (!flags) return false;
+    world->flags = flags;
+
+    Uint32 *categories = realloc(world->categories, capacity * sizeof(Uint32));
+    if (!categories) return false;
+    world->categories = categories;
+
+    BodyHandle *handles = realloc(world->handles, capacity * sizeof(BodyHandle));
+    if (!handles) return false;
+    world->handles = handles;
+
+    world->capacity = capacity;
+    return true;
+}
+
+PhysicsWorld *PhysicsWorld_Create(int capacity)
+{
+    PhysicsWorld *world = calloc(1, sizeof(PhysicsWorld));
+    if (!world) return NULL;
+
+    if (capacity < 16) capacity = 16;
+    if (!PhysicsWorld_GrowBodies(world, capacity)) {
+        fprintf(stderr, "[Physics] Out of memory creating world\n");
+        PhysicsWorld_Destroy(world);
+        return NULL;
+    }
+    return world;
+}
+
+void PhysicsWorld_Destroy(PhysicsWorld *world)
+{
+    if (!world) return;
+
+    free(world->x);
+    free(world->y);
+    free(world->vx);
+    free(world->vy);
+    free(world->w);
+    free(world->h);
+    free(world->gravity);
+    free(world->maxFallSpeed);
+    free(world->flags);
+    free(world->categories);
+    free(world->handles);
+    free(world->slots);
+    free(world->generations);
+    free(world);
+}
+
+// Adds a body at rest, without gravity until PhysicsWorld_SetGravity. Returns BODY_NONE when full.
+BodyHandle PhysicsWorld_Add(PhysicsWorld *world, float x, float y, float w, float h, Uint8 flags)
+{
+    if (!world) return BODY_NONE;
+
+    if (world->count == world->capacity && !PhysicsWorld_GrowBodies(world, world->capacity * 2)) {
+        fprintf(stderr, "[Physics] Out of memory adding a body\n");
+        return BODY_NONE;
+    }
+
+    Uint32 slot = world->freeSlot;
+    if (slot) {
+        world->freeSlot = world->slots[slot - 1];
+    } else {
+        if (world->slotCount >= PHYSICS_MAX_BODIES) {
+            fprintf(stderr, "[Physics] Body limit of %d reached\n", PHYSICS_MAX_BODIES);
+            return BODY_NONE;
+        }
+        if (world->slotCount == world->slotCapacity) {
+            int capacity = world->slotCapacity ? world->slotCapacity * 2 : 64;
+            Uint32 *slots = realloc(world->slots, capacity * sizeof(Uint32));
+            if (slots) world->slots = slots;
+            Uint32 *generations = slots ? realloc(world->generations, capacity * sizeof(Uint32)) : NULL;
+            if (!generations) {
+                fprintf(stderr, "[Physics] Out of memory adding a body\n");
+                return BODY_NONE;
+            }
+            world->generations = generations;
+            world->slotCapacity = capacity;
+        }
+        world->generations[world->slotCount] = 0;
+        slot = (Uint32)++world->slotCount;
+    }
+
+    int i = world->count++;
+    world->slots[slot - 1] = (Uint32)i;
+    world->x[i] = x;
+    world->y[i] = y;
+    world->vx[i] = 0.0f;
+    world->vy[i] = 0.0f;
+    world->w[i] = w;
+    world->h[i] = h;
+    world->gravity[i] = 0.0f;
+    world->maxFallSpeed[i] = MAX_FALL_SPEED;
+    world->flags[i] = flags;
+    world->categories[i] = BODY_CATEGORY_DEFAULT;
+    world->handles[i] = (world->generations[slot - 1] << PHYSICS_INDEX_BITS) | slot;
+    return world->handles[i];
+}
+
+// Dense index of the body, for reading or writing its arrays directly. -1 for a stale handle.
+// Indices move when bodies are removed, don't keep them across PhysicsWorld_Remove.
+int PhysicsWorld_Index(const PhysicsWorld *world, BodyHandle handle)
+{
+    if (!world || handle == BODY_NONE) return -1;
+
+    Uint32 slot = PHYSICS_SLOT(handle);
+    if (slot == 0 || slot > (Uint32)world->slotCount) return -1;
+    if (world->generations[slot - 1] != PhysicsWorld_Generation(handle)) return -1;
+    return (int)world->slots[slot - 1];
+}
+
+void PhysicsWorld_Remove(PhysicsWorld *world, BodyHandle handle)
+{
+    int i = PhysicsWorld_Index(world, handle);
+    if (i < 0) return;
+
+    // Last body fills the hole so the arrays stay packed
+    int last = --world->count;
+    if (i != last) {
+        world->x[i] = world->x[last];
+        world->y[i] = world->y[last];
+        world->vx[i] = world->vx[last];
+        world->vy[i] = world->vy[last];
+        world->w[i] = world->w[last];
+        world->h[i] = world->h[last];
+        world->gravity[i] = world->gravity[last];
+        world->maxFallSpeed[i] = world->maxFallSpeed[last];
+        world->flags[i] = world->flags[last];
+        world->categories[i] = world->categories[last];
+        world->handles[i] = world->handles[last];
+        world->slots[PHYSICS_SLOT(world->handles[i]) - 1] = (Uint32)i;
+    }
+
+    // The generation wraps within the bits left over by the slot index
+    Uint32 slot = PHYSICS_SLOT(handle);
+    world->generations[slot - 1] = (world->generations[slot - 1] + 1) & (0xFFFFFFFFu >> PHYSICS_INDEX_BITS);
+    world->slots[slot - 1] = world->freeSlot;
+    world->freeSlot = slot;
+}
+
+void PhysicsWorld_SetGravity(PhysicsWorld *world, BodyHandle handle, float gravity, float maxFallSpeed)
+{
+    int i = PhysicsWorld_Index(world, handle);
+    if (i < 0) return;
+    world->gravity[i] = gravity;
+    world->maxFallSpeed[i] = maxFallSpeed;
+}
+
+void PhysicsWorld_SetCategory(PhysicsWorld *world, BodyHandle handle, Uint32 categories)
+{
+    int i = PhysicsWorld_Index(world, handle);
+    if (i < 0) return;
+    world->categories[i] = categories;
+}
+
+// The body's box in whole pixels, the same rounding entities use for collisionCheck
+bool PhysicsWorld_GetRect(const PhysicsWorld *world, BodyHandle handle, SDL_Rect *rect)
+{
+    int i = PhysicsWorld_Index(world, handle);
+    if (i < 0 || !rect) return false;
+
+    rect->x = (int)world->x[i];
+    rect->y = (int)world->y[i];
+    rect->w = (int)world->w[i];
+    rect->h = (int)world->h[i];
+    return true;
+}
+
+// Copies an entity's PhysicsBody into the world before a step
+void PhysicsWorld_WriteBody(PhysicsWorld *world, BodyHandle handle, const PhysicsBody *body)
+{
+    int i = PhysicsWorld_Index(world, handle);
+    if (i < 0 || !body) return;
+
+    world->x[i] = body->x;
+    world->y[i] = body->y;
+    world->vx[i] = body->velocity_x;
+    world->vy[i] = body->velocity_y;
+    world->w[i] = (float)body->collisionRect.w;
+    world->h[i] = (float)body->collisionRect.h;
+    if (body->isOnGround) world->flags[i] |= BODY_ON_GROUND;
+    else world->flags[i] &= ~BODY_ON_GROUND;
+}
+
+// Copies the result of a step back into an entity's PhysicsBody
+void PhysicsWorld_ReadBody(const PhysicsWorld *world, BodyHandle handle, PhysicsBody *body)
+{
+    int i = PhysicsWorld_Index(world, handle);
+    if (i < 0 || !body) return;
+
+    body->x = world->x[i];
+    body->y = world->y[i];
+    body->velocity_x = world->vx[i];
+    body->velocity_y = world->vy[i];
+    body->isOnGround = (world->flags[i] & BODY_ON_GROUND) != 0;
+}
+
+typedef struct PhysicsStep {
+    PhysicsWorld *world;
+    const Level *lvl;
+    float deltaTime;
+} PhysicsStep;
+
+// One batch of bodies: gravity for the whole range first, a flat loop over the
+// arrays the compiler can vectorize, then the tile sweeps body by body
+static void PhysicsWorld_StepRange(void *data, int begin, int end)
+{
+    PhysicsStep *step = data;
+    PhysicsWorld *world = step->world;
+    float dt = step->deltaTime;
+
+    float *vy = world->vy;
+    const float *gravity = world->gravity;
+    const float *maxFall = world->maxFallSpeed;
+    for (int i = begin; i < end; i++) {
+        float v = vy[i] + gravity[i] * dt;
+        vy[i] = v > maxFall[i] ? maxFall[i] : v;
+    }
+
+    int probes = 0;
+    for (int i = begin; i < end; i++) {
+        Uint8 flags = world->flags[i] & ~BODY_CONTACTS;
+
+        if (!(flags & BODY_COLLIDES) || !step->lvl) {
+            world->x[i] += world->vx[i] * dt;
+            world->y[i] += world->vy[i] * dt;
+            world->flags[i] = flags;
+            continue;
+        }
+
+        SweepHit hitX, hitY;
+        moveBoxThroughTiles(step->lvl, &world->x[i], &world->y[i], world->w[i], world->h[i],
+                            &world->vx[i], &world->vy[i], dt, &hitX, &hitY, &probes);
+        if (hitX.hit) flags |= BODY_HIT_WALL;
+        if (hitY.hit) flags |= hitY.normalY < 0.0f ? (BODY_HIT_FLOOR | BODY_ON_GROUND) : BODY_HIT_CEILING;
+        world->flags[i] = flags;
+    }
+
+    COUNTER_ADD(COUNTER_COLLISION_PROBES, probes);
+}
+
+// Integrates gravity and moves every body through the tile grid. Large worlds are
+// split into batches over the job system; bodies don't interact, so batches don't
+// share anything but the read-only level.
+void PhysicsWorld_Step(PhysicsWorld *world, const Level *lvl, float deltaTime, JobSystem *jobs)
+{
+    if (!world || world->count == 0) return;
+
+    PhysicsStep step = { world, lvl, deltaTime };
+    if (jobs && world->count >= 2 * PHYSICS_PARALLEL_MIN) {
+        JobSystem_ParallelFor(jobs, world->count, PHYSICS_PARALLEL_MIN, PhysicsWorld_StepRange, &step);
+    } else {
+        PhysicsWorld_StepRange(&step, 0, world->count);
+    }
+
+    COUNTER_ADD(COUNTER_PHYSICS_BODIES, world->count);
+}
@@ -5,6 +5,10 @@
 #include "gameManager.h"
 #include "collision.h"
 #include "camera.h"
+#include "spriteBatch.h"
+#include "textureAtlas.h"
+#include "spatialHash.h"
+#include "aabbBatch.h"
 
 #include <cJSON.h>
 #include <stdio.h>
@@ -16,7 +20,55 @@
 
 int wait = 0;
 
-bool Player_LoadConfig(Player *player, struct mainSystems *systems, const char *filePath)
+// Moves an animation's frame rects to where its sheet landed in the atlas
+static void Player_MoveFrames(Animation *anim, const AtlasItem *items, int sheetCount)
+{
+    if (!anim->frames || anim->sheetIndex < 0 || anim->sheetIndex >= sheetCount) return;
+    const AtlasItem *item = &items[anim->sheetIndex];
+    if (item->page < 0) return;
+
+    for (int f = 0; f < anim->frameCount; f++) {
+        anim->frames[f].x += item->x;
+        anim->frames[f].y += item->y;
+    }
+}
+
+// Packs the sprite sheets into one atlas so all of the player's frames share a
+// texture, and rewrites the frame rects to match. Frames have empty margins, so the
+// sheets only get a transparent border. Sheets that don't fit stay where they are.
+static void Player_PackSheets(Player *player, SDL_Renderer *renderer)
+{
+    if (player->atlas || player->sheetCount <= 0) return;
+
+    AtlasItem *items = calloc(player->sheetCount, sizeof(AtlasItem));
+    if (!items) return;
+
+    for (int i = 0; i < player->sheetCount; i++) {
+        const SpriteSheet *sheet = &player->sheets[i];
+        if (!sheet->handle) continue;
+        items[i].source = sheet->texture;
+        items[i].w = sheet->handle->w;
+        items[i].h = sheet->handle->h;
+    }
+
+    player->atlas = TextureAtlas_Create(renderer, items, player->sheetCount);
+    if (player->atlas) {
+        for (int i = 0; i < player->sheetCount; i++) {
+            if (items[i].page >= 0) player->sheets[i].texture = player->atlas->pages[items[i].page];
+        }
+        for (int i = 0; i < player->anims.movementCount; i++) {
+            Player_MoveFrames(&player->anims.movements[i], items, player->sheetCount);
+        }
+        for (int i = 0; i < player->anims.attackCount; i++) {
+            for (int j = 0; j < player->anims.attacks[i].stageCount; j++) {
+                Player_MoveFrames(&player->anims.attacks[i].stages[j].animation, items, player->sheetCount);
+            }
+        }
+    }
+    free(items);
+}
+
+bool Player_LoadConfig(Player *player, TextureCache *textures, const char *filePath)
 {
     //Read the JSON file into a string
     char *file = read_whole_file(filePath);
@@ -54,6 +106,18 @@ bool Player_LoadConfig(Player *player, struct mainSystems *systems, const char *
     int numOfSheets = cJSON_GetArraySize(sheets);
     player->sheetCount = numOfSheets;
     SpriteSheet *spriteSheets = calloc(numOfSheets, sizeof(SpriteSheet));
+    // Owned by the player right away so Player_Destroy releases the handles on a failed load
+    player->sheets = spriteSheets;
+    // Sheet images are collected first and decoded together below
+    const char **sheetPaths = calloc(numOfSheets, sizeof(char *));
+    CachedTexture **sheetHandles = calloc(numOfSheets, sizeof(CachedTexture *));
+    if (numOfSheets > 0 && (!spriteSheets || !sheetPaths || !sheetHandles)) {
+        fprintf(stderr, "[PLAYER] Out of memory loading sprite sheets\n");
+        free(sheetPaths);
+        free(sheetHandles);
+        cJSON_Delete(configFile);
+        return false;
+    }
 
     int idx = 0;
     cJSON *sheets_idx = NULL;
@@ -69,16 +133,13 @@ bool Player_LoadConfig(Player *player, struct mainSystems *systems, const char *
         }
 
         if (cJSON_IsString(path)) {
-            spriteSheets[idx].texture = loadTexture(path->valuestring, systems->renderer);
-            if (!spriteSheets[idx].texture) {
-                fprintf(stderr, "[PLAYER] Failed to create texture from %s\n", path->valuestring);
-                cJSON_Delete(configFile);
-                return false;    
-            }
+            sheetPaths[idx] = path->valuestring;
         }
 
         if (!cJSON_IsString(name) || !cJSON_IsString(path)) {
             fprintf(stderr, "[PLAYER] Missing or invalid 'name' or 'path' in sheet entry\n");
+            free(sheetPaths);
+            free(sheetHandles);
             cJSON_Delete(configFile);
             return false;
         }
@@ -91,6 +152,8 @@ bool Player_LoadConfig(Player *player, struct mainSystems *systems, const char *
         }
         else {
             fprintf(stderr, "[PLAYER] Invalid Value for frameWidth/frameHeight!\n");
+            free(sheetPaths);
+            free(sheetHandles);
             cJSON_Delete(configFile);
             return false;
         }
@@ -98,7 +161,22 @@ bool Player_LoadConfig(Player *player, struct mainSystems *systems, const char *
         idx++;
     }
 
-    player->sheets = spriteSheets;
+    bool sheetsLoaded = TextureCache_AcquireMany(textures, sheetPaths, numOfSheets, sheetHandles);
+    for (int i = 0; i < numOfSheets; i++) {
+        spriteSheets[i].handle = sheetHandles[i];
+        if (sheetHandles[i]) {
+            spriteSheets[i].texture = sheetHandles[i]->tex;
+        } else {
+            fprintf(stderr, "[PLAYER] Failed to create texture from %s\n", sheetPaths[i]);
+        }
+    }
+    free(sheetPaths);
+    free(sheetHandles);
+    if (!sheetsLoaded) {
+        cJSON_Delete(configFile);
+        return false;
+    }
+
     printf("Loaded Sprite Sheets\n");
 
     // Load animations object
@@ -503,17 +581,69 @@ bool Player_LoadConfig(Player *player, struct mainSystems *systems, const char *
     player->comboExtendRequested = false;
     player->canBeInterrupted = true;
 
+    Player_PackSheets(player, textures->renderer);
+
     return true;
 }
 
+// Gives the player a body in the physics world, which moves it from then on
+bool Player_AttachPhysics(Player *player, PhysicsWorld *world)
+{
+    if (!player || !world) return false;
+
+    PhysicsWorld_Remove(player->world, player->bodyHandle);
+    player->bodyHandle = PhysicsWorld_Add(world, player->body.x, player->body.y,
+                                          (float)player->body.collisionRect.w, (float)player->body.collisionRect.h,
+                                          BODY_COLLIDES);
+    player->world = player->bodyHandle != BODY_NONE ? world : NULL;
+    PhysicsWorld_SetCategory(player->world, player->bodyHandle, BODY_CATEGORY_PLAYER);
+    return player->world != NULL;
+}
+
+// Bodies in `categories` that the active attack hitbox overlaps: broadphase candidates
+// first, then collisionCheck on each. Returns how many were written to `out`.
+int Player_FindAttackTargets(const Player *player, SpatialHash *broadphase, Uint32 categories,
+                             BodyHandle *out, int maxOut)
+{
+    if (!player || !player->hitboxActive || !player->world || !out) return 0;
+
+    SDL_Rect hitbox = { player->activeHitbox.x, player->activeHitbox.y, player->activeHitbox.w, player->activeHitbox.h };
+    BodyHandle candidates[64];
+    int count = SpatialHash_QueryRect(broadphase, player->world, &hitbox, categories, candidates, SDL_arraysize(candidates));
+
+    // Gather the candidates' boxes and test them all in one batch
+    SDL_Rect targets[SDL_arraysize(candidates)];
+    int targetCount = 0;
+    for (int i = 0; i < count; i++) {
+        if (candidates[i] == player->bodyHandle) continue;
+        if (!PhysicsWorld_GetRect(player->world, candidates[i], &targets[targetCount])) continue;
+        candidates[targetCount++] = candidates[i];
+    }
+
+    Uint32 hits[AABB_MASK_WORDS(SDL_arraysize(candidates))];
+    if (AABB_OverlapRects(&hitbox, targets, targetCount, hits) == 0) return 0;
+
+    int found = 0;
+    for (int i = 0; i < targetCount && found < maxOut; i++) {
+        if (hits[i >> 5] & (1u << (i & 31))) out[found++] = candidates[i];
+    }
+    return found;
+}
+
 void Player_Destroy(Player *player)
 {
     if (!player) return;
 
-    // Free sprite sheets
+    PhysicsWorld_Remove(player->world, player->bodyHandle);
+    player->world = NULL;
+    player->bodyHandle = BODY_NONE;
+
+    // Free sprite sheets, the atlas was drawn from them
+    TextureAtlas_Destroy(player->atlas);
+    player->atlas = NULL;
     for (int i = 0; i < player->sheetCount; i++) {
         if (player->sheets[i].name) free(player->sheets[i].name);
-        if (player->sheets[i].texture) SDL_DestroyTexture(player->sheets[i].texture);
+        TextureCache_Release(player->sheets[i].handle);
     }
     free(player->sheets);
     printf("Freed sprite sheets\n");
@@ -619,6 +749,14 @@ void Player_Update(Player *player, float deltaTime, Level *lvl)
         player->body.velocity_x = 0;
     }
     Player_UpdatePhysics(player, deltaTime, lvl);
+}
+
+// Second half of the player's step, once the physics world has moved the body
+void Player_AfterPhysics(Player *player, float deltaTime, Level *lvl)
+{
+    if (!player || !lvl) return;
+
+    PhysicsWorld_ReadBody(player->world, player->bodyHandle, &player->body);
 
     // Update state machine
     PlayerState newState = PLAYER_IDLE;
@@ -701,27 +839,26 @@ void Player_UpdatePhysics(Player *player, float deltaTime, Level *lvl)
 
     //Cant seem to figure this simple thing out
     float fallMultiplier = 1.15;
-    
+    float gravity = player->gravity;
     if (player->state == PLAYER_FALLING)
     {
-        player->body.velocity_y += player->gravity * fallMultiplier * deltaTime;
-    }
-    else
-    {
-        player->body.velocity_y += player->gravity * deltaTime;
+        gravity *= fallMultiplier;
     }
 
+    // The world applies gravity and moves the body along with every other body this
+    // step, Player_AfterPhysics picks up the result
+    if (player->world) {
+        PhysicsWorld_SetGravity(player->world, player->bodyHandle, gravity, player->maxFallSpeed);
+        PhysicsWorld_WriteBody(player->world, player->bodyHandle, &player->body);
+        return;
+    }
 
     // Apply gravity
+    player->body.velocity_y += gravity * deltaTime;
     if (player->body.velocity_y > player->maxFallSpeed) player->body.velocity_y = player->maxFallSpeed;
 
-    // Horizontal collision
-    player->body.x += player->body.velocity_x * deltaTime;
-    checkEntityTileCollisionsX(&player->body, lvl, deltaTime);
-
-    // Vertical collision
-    player->body.y += player->body.velocity_y * deltaTime;
-    checkEntityTileCollisionsY(&player->body, lvl, deltaTime);
+    // Swept against the tile grid, so fast falls and long steps can't tunnel through floors
+    PhysicsBody_Move(&player->body, lvl, deltaTime, NULL, NULL);
 }
 
 void Player_UpdateCollisionBox(Player *player, Level *lvl) {
@@ -998,9 +1135,19 @@ void Player_UpdateAnimation(Player *player, float deltaTime)
     }
 }
 
-void Player_Render(const Player *player, const struct mainSystems *systems, const Camera *camera, bool debug)
+// Body position interpolated between the last two simulation steps, rounded to pixels
+static void Player_DrawPosition(const Player *player, float alpha, int *drawX, int *drawY)
 {
-    if (!player || !systems || !systems->renderer) return;
+    float lerpX, lerpY;
+    PhysicsBody_RenderOffset(&player->body, alpha, &lerpX, &lerpY);
+    *drawX = (int)SDL_floorf(player->body.collisionRect.x + lerpX + 0.5f);
+    *drawY = (int)SDL_floorf(player->body.collisionRect.y + lerpY + 0.5f);
+}
+
+// Queues the current animation frame, the batch is drawn once everything is in
+void Player_Render(const Player *player, SpriteBatch *batch, const Camera *camera, float alpha)
+{
+    if (!player || !batch) return;
 
     // get current animation
     Animation *anim = NULL;
@@ -1021,9 +1168,12 @@ void Player_Render(const Player *player, const struct mainSystems *systems, cons
     destRect.w = (int)(frame.w * player->spriteScale);
     destRect.h = (int)(frame.h * player->spriteScale);
 
+    int drawX, drawY;
+    Player_DrawPosition(player, alpha, &drawX, &drawY);
+
     // Using collisionRect as anchor 
-    destRect.x = (int)(player->body.collisionRect.x - camera->x + (player->body.collisionRect.w - destRect.w) / 2);
-    destRect.y = (int)(player->body.collisionRect.y - camera->y + (player->body.collisionRect.h - destRect.h));
+    destRect.x = (int)(drawX - camera->x + (player->body.collisionRect.w - destRect.w) / 2);
+    destRect.y = (int)(drawY - camera->y + (player->body.collisionRect.h - destRect.h));
 
     // apply collision profile offsets if present
     CollisionProfile *profile = anim->collisionProfile ? anim->collisionProfile
@@ -1034,39 +1184,51 @@ void Player_Render(const Player *player, const struct mainSystems *systems, cons
         destRect.y += (int)(profile->offsetY * player->spriteScale);
     }
 
-    SDL_RenderCopyEx(systems->renderer, sheet->texture, &frame, &destRect, 0, NULL, player->body.flip);
-
-    // debug draw hitbox & collision
-    if (true) {
-        // collision rect
-        SDL_SetRenderDrawColor(systems->renderer, 0, 255, 0, 100);
-        SDL_Rect collRect = {
-            player->body.collisionRect.x - camera->x,
-            player->body.collisionRect.y - camera->y,
-            player->body.collisionRect.w,
-            player->body.collisionRect.h
+    SpriteBatch_Draw(batch, sheet->texture, &frame, &destRect, player->body.flip, SPRITE_LAYER_PLAYER);
+}
+
+// Collision rect and active hitbox outlines, drawn straight to the renderer after the sprites
+void Player_RenderDebug(const Player *player, SDL_Renderer *renderer, const Camera *camera, float alpha)
+{
+    if (!player || !renderer) return;
+
+    int drawX, drawY;
+    Player_DrawPosition(player, alpha, &drawX, &drawY);
+
+    // collision rect
+    SDL_SetRenderDrawColor(renderer, 0, 255, 0, 100);
+    SDL_Rect collRect = {
+        drawX - camera->x,
+        drawY - camera->y,
+        player->body.collisionRect.w,
+        player->body.collisionRect.h
+    };
+    SDL_RenderDrawRect(renderer, &collRect);
+
+    // active hitbox
+    if (player->hitboxActive) {
+        SDL_SetRenderDrawColor(renderer, 255, 0, 0, 100);
+        SDL_Rect hitRect = {
+            player->activeHitbox.x + (drawX - player->body.collisionRect.x) - camera->x,
+            player->activeHitbox.y + (drawY - player->body.collisionRect.y) - camera->y,
+            player->activeHitbox.w,
+            player->activeHitbox.h
         };
-        SDL_RenderDrawRect(systems->renderer, &collRect);
-
-        // active hitbox
-        if (player->hitboxActive) {
-            SDL_SetRenderDrawColor(systems->renderer, 255, 0, 0, 100);
-            SDL_Rect hitRect = {
-                player->activeHitbox.x - camera->x,
-                player->activeHitbox.y - camera->y,
-                player->activeHitbox.w,
-                player->activeHitbox.h
-            };
-            SDL_RenderDrawRect(systems->renderer, &hitRect);
-        }
+        SDL_RenderDrawRect(renderer, &hitRect);
     }
 }
 
 void Player_HandleInput(Player *player) 
 {
-    if (!player) return;
+    Player_HandleInputState(player, SDL_GetKeyboardState(NULL));
+}
+
+// Same as Player_HandleInput with the key state passed in (indexed by scancode, like
+// SDL_GetKeyboardState), so scripted input can drive the player
+void Player_HandleInputState(Player *player, const Uint8 *state)
+{
+    if (!player || !state) return;
 
-    const Uint8 *state = SDL_GetKeyboardState(NULL);
     #define SAFE_STATE(scancode) ((scancode >= 0 && scancode < SDL_NUM_SCANCODES) ? state[scancode] : 0)
 
    // If attack animation is active, only allow combo requests in the last X frames
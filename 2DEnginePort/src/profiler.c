@@ -0,0 +1,304 @@
+#include "profiler.h"
+#include "debugText.h"
+#include "counters.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define PROFILER_OVERLAY_SCALE 2
+#define PROFILER_OVERLAY_WIDTH 420
+#define PROFILER_OVERLAY_BAR_X 300      // ms column and bars start here
+
+typedef struct Profiler {
+    bool initialized;
+    SDL_threadID thread;            // the only thread that records
+    Uint64 frequency;
+    Uint64 origin;                  // trace timestamps count from here
+    ProfileFrame startup;
+    ProfileFrame frames[PROFILER_FRAMES];
+    Uint32 frameCount;              // frames begun since Init, frame n sits in frames[n % PROFILER_FRAMES]
+    ProfileFrame *current;          // NULL between EndFrame and BeginFrame
+    int stack[PROFILER_MAX_DEPTH];  // open scopes, -1 for one that didn't fit in the frame
+    int depth;
+    int overflow;                   // scopes opened past PROFILER_MAX_DEPTH
+} Profiler;
+
+static Profiler profiler;
+
+void Profiler_Init(void)
+{
+    memset(&profiler, 0, sizeof(Profiler));
+    profiler.thread = SDL_ThreadID();
+    profiler.frequency = SDL_GetPerformanceFrequency();
+    profiler.origin = SDL_GetPerformanceCounter();
+    profiler.startup.start = profiler.origin;
+    profiler.current = &profiler.startup;
+    profiler.initialized = true;
+    Counters_Init();
+}
+
+double Profiler_TicksToMs(Uint64 ticks)
+{
+    return profiler.frequency ? (double)ticks * 1000.0 / profiler.frequency : 0.0;
+}
+
+// Scopes left open are closed at `now`, so a missing PROFILE_END can't stretch into the next frame
+static void Profiler_CloseFrame(Uint64 now)
+{
+    ProfileFrame *frame = profiler.current;
+    for (int i = 0; i < profiler.depth; i++) {
+        if (profiler.stack[i] >= 0) frame->scopes[profiler.stack[i]].end = now;
+    }
+    frame->end = now;
+    profiler.current = NULL;
+    profiler.depth = 0;
+    profiler.overflow = 0;
+}
+
+void Profiler_BeginFrame(void)
+{
+    if (!profiler.initialized) return;
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (profiler.current) Profiler_CloseFrame(now);
+    Counters_BeginFrame();
+
+    profiler.frameCount++;
+    ProfileFrame *frame = &profiler.frames[profiler.frameCount % PROFILER_FRAMES];
+    frame->start = now;
+    frame->end = 0;
+    frame->number = profiler.frameCount;
+    frame->count = 0;
+    profiler.current = frame;
+}
+
+void Profiler_EndFrame(void)
+{
+    if (!profiler.current) return;
+    Profiler_CloseFrame(SDL_GetPerformanceCounter());
+    Counters_EndFrame();
+}
+
+void Profiler_Begin(const char *name)
+{
+    ProfileFrame *frame = profiler.current;
+    if (!frame || SDL_ThreadID() != profiler.thread) return;
+
+    if (profiler.depth == PROFILER_MAX_DEPTH) {
+        profiler.overflow++;
+        return;
+    }
+
+    int index = -1;
+    if (frame->count < PROFILER_MAX_SCOPES) {
+        index = frame->count++;
+        ProfileScope *scope = &frame->scopes[index];
+        scope->name = name;
+        scope->parent = (Sint16)(profiler.depth > 0 ? profiler.stack[profiler.depth - 1] : -1);
+        scope->depth = (Sint16)profiler.depth;
+        scope->end = 0;
+        scope->start = SDL_GetPerformanceCounter();
+    }
+    profiler.stack[profiler.depth++] = index;
+}
+
+void Profiler_End(void)
+{
+    Uint64 now = SDL_GetPerformanceCounter();
+    ProfileFrame *frame = profiler.current;
+    if (!frame || SDL_ThreadID() != profiler.thread) return;
+
+    if (profiler.overflow > 0) {
+        profiler.overflow--;
+        return;
+    }
+    if (profiler.depth == 0) return;
+
+    int index = profiler.stack[--profiler.depth];
+    if (index >= 0) frame->scopes[index].end = now;
+}
+
+// Most recent frame that has ended, NULL before the first one
+const ProfileFrame *Profiler_LastFrame(void)
+{
+    for (Uint32 n = profiler.frameCount; n > 0 && n + PROFILER_FRAMES > profiler.frameCount; n--) {
+        const ProfileFrame *frame = &profiler.frames[n % PROFILER_FRAMES];
+        if (frame->number == n && frame->end != 0) return frame;
+    }
+    return NULL;
+}
+
+const ProfileFrame *Profiler_StartupFrame(void)
+{
+    return profiler.initialized ? &profiler.startup : NULL;
+}
+
+// Average of scope `index` of `reference` over the ring. Frames usually open the same
+// scopes in the same order, so a scope is matched by position, name and depth.
+static double Profiler_AverageScopeMs(const ProfileFrame *reference, int index, int *samples)
+{
+    const ProfileScope *match = &reference->scopes[index];
+    Uint64 total = 0;
+    int count = 0;
+
+    for (int i = 0; i < PROFILER_FRAMES; i++) {
+        const ProfileFrame *frame = &profiler.frames[i];
+        if (frame->number == 0 || frame->end == 0 || frame->count <= index) continue;
+
+        const ProfileScope *scope = &frame->scopes[index];
+        if (scope->name != match->name || scope->depth != match->depth || scope->end < scope->start) continue;
+        total += scope->end - scope->start;
+        count++;
+    }
+    if (samples) *samples = count;
+    return count > 0 ? Profiler_TicksToMs(total) / count : 0.0;
+}
+
+static double Profiler_AverageFrameMs(void)
+{
+    Uint64 total = 0;
+    int count = 0;
+    for (int i = 0; i < PROFILER_FRAMES; i++) {
+        const ProfileFrame *frame = &profiler.frames[i];
+        if (frame->number == 0 || frame->end == 0) continue;
+        total += frame->end - frame->start;
+        count++;
+    }
+    return count > 0 ? Profiler_TicksToMs(total) / count : 0.0;
+}
+
+// Scope tree of the last finished frame with each scope's average over the ring, and
+// a bar showing its share of the average frame. The frame counters follow below.
+void Profiler_RenderOverlay(SDL_Renderer *renderer, int x, int y)
+{
+    const ProfileFrame *last = Profiler_LastFrame();
+    if (!renderer || !last) return;
+
+    const int scale = PROFILER_OVERLAY_SCALE;
+    const int lineHeight = (DEBUGTEXT_GLYPH_H + 2) * scale;
+    const int barWidth = PROFILER_OVERLAY_WIDTH - PROFILER_OVERLAY_BAR_X - 8;
+    double frameMs = Profiler_AverageFrameMs();
+    char line[128];
+
+    SDL_BlendMode oldBlend;
+    SDL_GetRenderDrawBlendMode(renderer, &oldBlend);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+    int lines = 1 + last->count + 1 + Counters_Count();
+    SDL_Rect panel = {x, y, PROFILER_OVERLAY_WIDTH, lines * lineHeight + 2 * scale * 2};
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 170);
+    SDL_RenderFillRect(renderer, &panel);
+
+    int penX = x + 2 * scale;
+    int penY = y + 2 * scale;
+    snprintf(line, sizeof(line), "FRAME %.2f MS  (%.0f FPS)", frameMs, frameMs > 0.0 ? 1000.0 / frameMs : 0.0);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
+    DebugText_Draw(renderer, penX, penY, scale, line);
+
+    for (int i = 0; i < last->count; i++) {
+        const ProfileScope *scope = &last->scopes[i];
+        double ms = Profiler_AverageScopeMs(last, i, NULL);
+        penY += lineHeight;
+
+        snprintf(line, sizeof(line), "%*s%s", scope->depth * 2, "", scope->name ? scope->name : "?");
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        DebugText_Draw(renderer, penX, penY, scale, line);
+
+        snprintf(line, sizeof(line), "%6.2f", ms);
+        DebugText_Draw(renderer, x + PROFILER_OVERLAY_BAR_X - DebugText_Width(line, scale) - 4 * scale, penY, scale, line);
+
+        int w = frameMs > 0.0 ? (int)(barWidth * SDL_min(ms / frameMs, 1.0)) : 0;
+        SDL_Rect bar = {x + PROFILER_OVERLAY_BAR_X, penY, SDL_max(w, 1), DEBUGTEXT_GLYPH_H * scale};
+        SDL_SetRenderDrawColor(renderer, 80, 200, 120, 255);
+        SDL_RenderFillRect(renderer, &bar);
+    }
+
+    // Counters: last frame, and the average over the history
+    penY += lineHeight;
+    for (int i = 0; i < Counters_Count(); i++) {
+        CounterStats stats;
+        Counters_GetStats(i, &stats);
+        penY += lineHeight;
+
+        SDL_SetRenderDrawColor(renderer, 140, 200, 255, 255);
+        DebugText_Draw(renderer, penX, penY, scale, Counters_Name(i));
+
+        snprintf(line, sizeof(line), "%llu", (unsigned long long)stats.last);
+        DebugText_Draw(renderer, x + PROFILER_OVERLAY_BAR_X - DebugText_Width(line, scale) - 4 * scale, penY, scale, line);
+        snprintf(line, sizeof(line), "(%.0f)", stats.avg);
+        DebugText_Draw(renderer, x + PROFILER_OVERLAY_BAR_X, penY, scale, line);
+    }
+
+    SDL_SetRenderDrawBlendMode(renderer, oldBlend);
+}
+
+static double Profiler_TraceMicros(Uint64 ticks)
+{
+    return ticks > profiler.origin ? Profiler_TicksToMs(ticks - profiler.origin) * 1000.0 : 0.0;
+}
+
+static void Profiler_WriteName(FILE *file, const char *name)
+{
+    fputc('"', file);
+    for (const char *c = name ? name : "?"; *c; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', file);
+        if ((unsigned char)*c >= 0x20) fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+static void Profiler_WriteEvent(FILE *file, bool *first, const char *name, const char *category, Uint64 start, Uint64 end)
+{
+    fputs(*first ? "\n  {\"name\":" : ",\n  {\"name\":", file);
+    Profiler_WriteName(file, name);
+    fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+            category, Profiler_TraceMicros(start), Profiler_TicksToMs(end - start) * 1000.0);
+    *first = false;
+}
+
+static void Profiler_WriteFrame(FILE *file, bool *first, const ProfileFrame *frame, const char *name, const char *category)
+{
+    Profiler_WriteEvent(file, first, name, category, frame->start, frame->end);
+    for (int i = 0; i < frame->count; i++) {
+        const ProfileScope *scope = &frame->scopes[i];
+        if (scope->end < scope->start || scope->end == 0) continue;
+        Profiler_WriteEvent(file, first, scope->name, category, scope->start, scope->end);
+    }
+}
+
+// Chrome trace-event JSON (chrome://tracing, Perfetto) with the startup phases and
+// every finished frame still in the ring
+bool Profiler_ExportTrace(const char *path)
+{
+    if (!profiler.initialized || !path) return false;
+
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "[Profiler] Failed to open '%s' for writing\n", path);
+        return false;
+    }
+
+    bool first = true;
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+
+    if (profiler.startup.end != 0) {
+        Profiler_WriteFrame(file, &first, &profiler.startup, "Startup", "startup");
+    }
+
+    Uint32 oldest = profiler.frameCount >= PROFILER_FRAMES ? profiler.frameCount - PROFILER_FRAMES + 1 : 1;
+    int written = 0;
+    for (Uint32 n = oldest; n <= profiler.frameCount && n != 0; n++) {
+        const ProfileFrame *frame = &profiler.frames[n % PROFILER_FRAMES];
+        if (frame->number != n || frame->end == 0) continue;
+        Profiler_WriteFrame(file, &first, frame, "Frame", "frame");
+        written++;
+    }
+
+    fputs("\n]}\n", file);
+    bool ok = !ferror(file);
+    if (fclose(file) != 0) ok = false;
+
+    if (ok) fprintf(stderr, "[Profiler] Wrote %d frame(s) to '%s'\n", written, path);
+    else fprintf(stderr, "[Profiler] Failed writing '%s'\n", path);
+    return ok;
+}
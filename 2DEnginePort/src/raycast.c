@@ -0,0 +1,155 @@
+#include "raycast.h"
+#include "level.h"
+#include "jobSystem.h"
+#include "counters.h"
+
+#include <float.h>
+#include <math.h>
+
+static void Raycast_Miss(RayHit *hit, float originX, float originY, float dirX, float dirY, float maxDistance)
+{
+    hit->hit = false;
+    hit->distance = maxDistance;
+    hit->x = originX + dirX * maxDistance;
+    hit->y = originY + dirY * maxDistance;
+    hit->col = -1;
+    hit->row = -1;
+    hit->normalX = 0;
+    hit->normalY = 0;
+}
+
+static void Raycast_Normalize(float *dirX, float *dirY)
+{
+    float length = sqrtf(*dirX * *dirX + *dirY * *dirY);
+    if (length > 0.0f) {
+        *dirX /= length;
+        *dirY /= length;
+    }
+}
+
+// The walk itself, dir already normalized. Adds the cells it tested to *cells.
+static bool Raycast_Walk(const Level *lvl, float originX, float originY, float dirX, float dirY,
+                         float maxDistance, RayHit *hit, int *cells)
+{
+    Raycast_Miss(hit, originX, originY, dirX, dirY, maxDistance);
+    if (!lvl || !lvl->solidGrid || lvl->tileSize <= 0) return false;
+
+    float tile = (float)lvl->tileSize;
+    int col = (int)floorf(originX / tile);
+    int row = (int)floorf(originY / tile);
+    int stepX = dirX > 0.0f ? 1 : (dirX < 0.0f ? -1 : 0);
+    int stepY = dirY > 0.0f ? 1 : (dirY < 0.0f ? -1 : 0);
+
+    // Distance along the ray to the next vertical / horizontal grid line, and between two of them
+    float deltaX = stepX ? tile / fabsf(dirX) : FLT_MAX;
+    float deltaY = stepY ? tile / fabsf(dirY) : FLT_MAX;
+    float nextX = stepX > 0 ? ((col + 1) * tile - originX) / dirX
+                : stepX < 0 ? (col * tile - originX) / dirX : FLT_MAX;
+    float nextY = stepY > 0 ? ((row + 1) * tile - originY) / dirY
+                : stepY < 0 ? (row * tile - originY) / dirY : FLT_MAX;
+
+    float t = 0.0f;
+    int normalX = 0, normalY = 0;
+    for (;;) {
+        (*cells)++;
+        if (level_isCellSolid(lvl, col, row)) {
+            hit->hit = true;
+            hit->distance = t;
+            hit->x = originX + dirX * t;
+            hit->y = originY + dirY * t;
+            hit->col = col;
+            hit->row = row;
+            hit->normalX = normalX;
+            hit->normalY = normalY;
+            return true;
+        }
+
+        // Outside the grid and moving further away, nothing left to hit
+        if ((col < 0 && stepX <= 0) || (col >= lvl->levelColumns && stepX >= 0) ||
+            (row < 0 && stepY <= 0) || (row >= lvl->levelRows && stepY >= 0)) {
+            return false;
+        }
+
+        if (nextX < nextY) {
+            t = nextX;
+            if (t >= maxDistance) return false;
+            col += stepX;
+            nextX += deltaX;
+            normalX = -stepX;
+            normalY = 0;
+        } else {
+            t = nextY;
+            if (t >= maxDistance) return false;
+            row += stepY;
+            nextY += deltaY;
+            normalX = 0;
+            normalY = -stepY;
+        }
+    }
+}
+
+// First solid cell along the ray within maxDistance. Cells outside the level are
+// empty, like level_isCellSolid. Returns hit->hit.
+bool Raycast_Cast(const Level *lvl, float originX, float originY, float dirX, float dirY, float maxDistance,
+                  RayHit *hit)
+{
+    if (!hit) return false;
+
+    Raycast_Normalize(&dirX, &dirY);
+    if (maxDistance < 0.0f) maxDistance = 0.0f;
+
+    int cells = 0;
+    bool found = Raycast_Walk(lvl, originX, originY, dirX, dirY, maxDistance, hit, &cells);
+    COUNTER_ADD(COUNTER_RAY_CELLS, cells);
+    return found;
+}
+
+// True when no solid cell lies between the two points, e.g. an enemy's eyes and the player
+bool Raycast_LineOfSight(const Level *lvl, float fromX, float fromY, float toX, float toY)
+{
+    RayHit hit;
+    float dx = toX - fromX;
+    float dy = toY - fromY;
+    return !Raycast_Cast(lvl, fromX, fromY, dx, dy, sqrtf(dx * dx + dy * dy), &hit);
+}
+
+typedef struct RaycastBatch {
+    const Level *lvl;
+    const Ray *rays;
+    RayHit *hits;
+} RaycastBatch;
+
+static void Raycast_BatchRange(void *data, int begin, int end)
+{
+    RaycastBatch *batch = data;
+
+    int cells = 0;
+    for (int i = begin; i < end; i++) {
+        const Ray *ray = &batch->rays[i];
+        float dirX = ray->dirX, dirY = ray->dirY;
+        Raycast_Normalize(&dirX, &dirY);
+        float maxDistance = ray->maxDistance > 0.0f ? ray->maxDistance : 0.0f;
+        Raycast_Walk(batch->lvl, ray->originX, ray->originY, dirX, dirY, maxDistance, &batch->hits[i], &cells);
+    }
+
+    COUNTER_ADD(COUNTER_RAY_CELLS, cells);
+}
+
+// Casts every ray, hits[i] for rays[i], and returns how many hit something. Perception
+// for all enemies in one call; large batches are spread over the job system since
+// rays only read the level.
+int Raycast_Batch(const Level *lvl, const Ray *rays, int count, RayHit *hits, JobSystem *jobs)
+{
+    if (!rays || !hits || count <= 0) return 0;
+
+    RaycastBatch batch = { lvl, rays, hits };
+    if (jobs && count >= 2 * RAYCAST_PARALLEL_MIN) {
+        JobSystem_ParallelFor(jobs, count, RAYCAST_PARALLEL_MIN, Raycast_BatchRange, &batch);
+    } else {
+        Raycast_BatchRange(&batch, 0, count);
+    }
+
+    int found = 0;
+    for (int i = 0; i < count; i++) found += hits[i].hit;
+    return found;
+}
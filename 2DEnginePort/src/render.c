@@ -4,12 +4,35 @@
 
 #include "SDL_render.h"
 #include "camera.h"
+#include "profiler.h"
 
 void render(GameManager *gm)
 {
     SDL_SetRenderDrawColor(gm->mainSystems.renderer, 0, 0, 0, 255);
     SDL_RenderClear(gm->mainSystems.renderer);
-    renderLevel(gm);
-    Player_Render(gm->player, &gm->mainSystems, &gm->camera, gm->settings.gameplay.debugMode);
+
+    // Everything is drawn between the last two simulation steps
+    Camera view = Camera_Interpolated(&gm->camera, gm->renderAlpha);
+    PROFILE_BEGIN("renderLevel");
+    renderLevel(gm, &view);
+    PROFILE_END();
+
+    // Characters go through the sprite batch, one draw call per texture
+    PROFILE_BEGIN("Sprites");
+    SpriteBatch_Begin(&gm->sprites);
+    Player_Render(gm->player, &gm->sprites, &view, gm->renderAlpha);
+    SpriteBatch_Flush(&gm->sprites, gm->mainSystems.renderer);
+    PROFILE_END();
+
+    if (gm->settings.gameplay.debugMode) {
+        Player_RenderDebug(gm->player, gm->mainSystems.renderer, &view, gm->renderAlpha);
+    }
+
+    if (gm->settings.gameplay.debugMode) {
+        Profiler_RenderOverlay(gm->mainSystems.renderer, 8, 8);
+    }
+
+    PROFILE_BEGIN("Present");
     SDL_RenderPresent(gm->mainSystems.renderer);
+    PROFILE_END();
 }
\ No newline at end of file
@@ -92,13 +92,21 @@ bool Settings_Load(GameSettings *settings, const char *filePath)
         settings->video.height     = json_get_int(video, "resolutionHeight", settings->video.height);
         settings->video.fullscreen = json_get_bool(video, "fullscreen", settings->video.fullscreen);
         settings->video.vsync      = json_get_bool(video, "vSync",      settings->video.vsync);
+        settings->video.targetFps  = json_get_int(video, "targetFps",  settings->video.targetFps);
         settings->video.scale      = json_get_number(video, "scale",    settings->video.scale);
+        settings->video.batchTiles = json_get_bool(video, "batchTiles", settings->video.batchTiles);
+        settings->video.chunkCacheMB = json_get_int(video, "chunkCacheMB", settings->video.chunkCacheMB);
+        settings->video.uploadBudgetMs = json_get_number(video, "uploadBudgetMs", settings->video.uploadBudgetMs);
+        settings->video.prefetchMB = json_get_int(video, "prefetchMB", settings->video.prefetchMB);
+        settings->video.textureCacheMB = json_get_int(video, "textureCacheMB", settings->video.textureCacheMB);
     }
 
     // Gameplay
     cJSON *gameplay = cJSON_GetObjectItemCaseSensitive(root, "gameplaySettings");
     if (gameplay) {
         settings->gameplay.debugMode = json_get_bool(gameplay, "debugMode", settings->gameplay.debugMode);
+        settings->gameplay.simulationHz = json_get_int(gameplay, "simulationHz", settings->gameplay.simulationHz);
+        settings->gameplay.maxStepsPerFrame = json_get_int(gameplay, "maxStepsPerFrame", settings->gameplay.maxStepsPerFrame);
     }
 
     cJSON_Delete(root);
@@ -136,12 +144,20 @@ bool Settings_Save(const GameSettings *settings, const char *filePath) {
     cJSON_AddNumberToObject(video, "resolutionHeight", settings->video.height);
     cJSON_AddBoolToObject(video,   "fullscreen",       settings->video.fullscreen);
     cJSON_AddBoolToObject(video,   "vSync",            settings->video.vsync);
+    cJSON_AddNumberToObject(video, "targetFps",        settings->video.targetFps);
     cJSON_AddNumberToObject(video, "scale",            settings->video.scale);
+    cJSON_AddBoolToObject(video,   "batchTiles",       settings->video.batchTiles);
+    cJSON_AddNumberToObject(video, "chunkCacheMB",     settings->video.chunkCacheMB);
+    cJSON_AddNumberToObject(video, "uploadBudgetMs",   settings->video.uploadBudgetMs);
+    cJSON_AddNumberToObject(video, "prefetchMB",       settings->video.prefetchMB);
+    cJSON_AddNumberToObject(video, "textureCacheMB",   settings->video.textureCacheMB);
 
     // Gameplay
     cJSON *gameplay = cJSON_CreateObject();
     cJSON_AddItemToObject(root, "gameplaySettings", gameplay);
     cJSON_AddBoolToObject(gameplay, "debugMode", settings->gameplay.debugMode);
+    cJSON_AddNumberToObject(gameplay, "simulationHz", settings->gameplay.simulationHz);
+    cJSON_AddNumberToObject(gameplay, "maxStepsPerFrame", settings->gameplay.maxStepsPerFrame);
 
     char *jsonString = cJSON_Print(root); 
 
@@ -176,13 +192,21 @@ void Settings_SetDefaults(GameSettings *settings) {
     settings->video.height      = 720;
     settings->video.fullscreen  = false;
     settings->video.vsync       = true;
+    settings->video.targetFps   = 60;
     settings->video.scale       = 1.0f;
+    settings->video.batchTiles  = true;
+    settings->video.chunkCacheMB = 64;
+    settings->video.uploadBudgetMs = 2.0f;
+    settings->video.prefetchMB = 128;
+    settings->video.textureCacheMB = 256;
 
     settings->audio.masterVolume = 0.8f;
     settings->audio.musicVolume  = 0.5f;
     settings->audio.sfxVolume    = 0.7f;
 
     settings->gameplay.debugMode = false;
+    settings->gameplay.simulationHz = 60;
+    settings->gameplay.maxStepsPerFrame = 5;
 }
 
 bool Settings_Init(GameSettings *settings, const char *filePath) {
@@ -0,0 +1,214 @@
+#include "spatialHash.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int SpatialHash_Bucket(int cx, int cy)
+{
+    Uint32 h = (Uint32)cx * 73856093u ^ (Uint32)cy * 19349663u;
+    return (int)(h & (SPATIAL_BUCKETS - 1));
+}
+
+static int SpatialHash_Cell(const SpatialHash *hash, float v)
+{
+    return (int)floorf(v / hash->cellSize);
+}
+
+SpatialHash *SpatialHash_Create(float cellSize)
+{
+    SpatialHash *hash = calloc(1, sizeof(SpatialHash));
+    if (!hash) return NULL;
+
+    hash->cellSize = cellSize > 0.0f ? cellSize : SPATIAL_CELL_SIZE;
+    hash->freeNode = -1;
+    hash->buckets = malloc(SPATIAL_BUCKETS * sizeof(int));
+    if (!hash->buckets) {
+        free(hash);
+        return NULL;
+    }
+    for (int i = 0; i < SPATIAL_BUCKETS; i++) hash->buckets[i] = -1;
+    return hash;
+}
+
+void SpatialHash_Destroy(SpatialHash *hash)
+{
+    if (!hash) return;
+    free(hash->buckets);
+    free(hash->nodes);
+    free(hash->proxies);
+    free(hash);
+}
+
+static bool SpatialHash_Link(SpatialHash *hash, BodyHandle handle, int cx, int cy)
+{
+    int n = hash->freeNode;
+    if (n >= 0) {
+        hash->freeNode = hash->nodes[n].next;
+    } else {
+        if (hash->nodeCount == hash->nodeCapacity) {
+            int capacity = hash->nodeCapacity ? hash->nodeCapacity * 2 : 256;
+            SpatialNode *nodes = realloc(hash->nodes, capacity * sizeof(SpatialNode));
+            if (!nodes) return false;
+            hash->nodes = nodes;
+            hash->nodeCapacity = capacity;
+        }
+        n = hash->nodeCount++;
+    }
+
+    int bucket = SpatialHash_Bucket(cx, cy);
+    hash->nodes[n] = (SpatialNode){ handle, cx, cy, hash->buckets[bucket] };
+    hash->buckets[bucket] = n;
+    return true;
+}
+
+static void SpatialHash_Unlink(SpatialHash *hash, BodyHandle handle, int cx, int cy)
+{
+    int *link = &hash->buckets[SpatialHash_Bucket(cx, cy)];
+    while (*link >= 0) {
+        SpatialNode *node = &hash->nodes[*link];
+        if (node->handle == handle && node->cx == cx && node->cy == cy) {
+            int n = *link;
+            *link = node->next;
+            node->next = hash->freeNode;
+            hash->freeNode = n;
+            return;
+        }
+        link = &node->next;
+    }
+}
+
+static void SpatialHash_RemoveProxy(SpatialHash *hash, SpatialProxy *proxy)
+{
+    for (int cy = proxy->minY; cy <= proxy->maxY; cy++) {
+        for (int cx = proxy->minX; cx <= proxy->maxX; cx++) {
+            SpatialHash_Unlink(hash, proxy->handle, cx, cy);
+        }
+    }
+    proxy->handle = BODY_NONE;
+}
+
+static bool SpatialHash_GrowProxies(SpatialHash *hash, int slotCount)
+{
+    if (slotCount <= hash->proxyCapacity) return true;
+
+    int capacity = hash->proxyCapacity ? hash->proxyCapacity : 64;
+    while (capacity < slotCount) capacity *= 2;
+    SpatialProxy *proxies = realloc(hash->proxies, capacity * sizeof(SpatialProxy));
+    if (!proxies) return false;
+    memset(&proxies[hash->proxyCapacity], 0, (capacity - hash->proxyCapacity) * sizeof(SpatialProxy));
+    hash->proxies = proxies;
+    hash->proxyCapacity = capacity;
+    return true;
+}
+
+// Brings the hash up to date with the world: drops removed bodies and moves the
+// ones whose box now covers different cells. Bodies that stayed within their
+// cells cost one range compare.
+void SpatialHash_Sync(SpatialHash *hash, const PhysicsWorld *world)
+{
+    if (!hash || !world) return;
+    if (!SpatialHash_GrowProxies(hash, world->slotCount)) {
+        fprintf(stderr, "[SpatialHash] Out of memory tracking %d bodies\n", world->slotCount);
+        return;
+    }
+
+    // Slots whose body was removed, or removed and reused by a new one
+    for (int s = 0; s < world->slotCount; s++) {
+        SpatialProxy *proxy = &hash->proxies[s];
+        if (proxy->handle != BODY_NONE && PhysicsWorld_Index(world, proxy->handle) < 0) {
+            SpatialHash_RemoveProxy(hash, proxy);
+        }
+    }
+
+    for (int i = 0; i < world->count; i++) {
+        BodyHandle handle = world->handles[i];
+        SpatialProxy *proxy = &hash->proxies[PHYSICS_SLOT(handle) - 1];
+
+        int minX = SpatialHash_Cell(hash, world->x[i]);
+        int minY = SpatialHash_Cell(hash, world->y[i]);
+        int maxX = SpatialHash_Cell(hash, world->x[i] + world->w[i]);
+        int maxY = SpatialHash_Cell(hash, world->y[i] + world->h[i]);
+
+        if (proxy->handle == handle && proxy->minX == minX && proxy->minY == minY &&
+            proxy->maxX == maxX && proxy->maxY == maxY) {
+            continue;
+        }
+
+        if (proxy->handle != BODY_NONE) SpatialHash_RemoveProxy(hash, proxy);
+
+        proxy->handle = handle;
+        proxy->minX = minX;
+        proxy->minY = minY;
+        proxy->maxX = maxX;
+        proxy->maxY = maxY;
+        for (int cy = minY; cy <= maxY; cy++) {
+            for (int cx = minX; cx <= maxX; cx++) {
+                if (SpatialHash_Link(hash, handle, cx, cy)) continue;
+
+                // Unlinking cells that never got a node is harmless, so drop the whole range
+                fprintf(stderr, "[SpatialHash] Out of memory inserting a body\n");
+                SpatialHash_RemoveProxy(hash, proxy);
+                return;
+            }
+        }
+    }
+}
+
+// Bodies in the cells covering [x0, x1] x [y0, y1] whose category matches the mask,
+// each at most once. Returns the number written to `out`.
+static int SpatialHash_QueryCells(SpatialHash *hash, const PhysicsWorld *world, int x0, int y0, int x1, int y1,
+                                  Uint32 categoryMask, BodyHandle *out, int maxOut)
+{
+    if (++hash->stamp == 0) {
+        // Wrapped around, old stamps could collide with new ones
+        for (int i = 0; i < hash->proxyCapacity; i++) hash->proxies[i].stamp = 0;
+        hash->stamp = 1;
+    }
+
+    int found = 0;
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            for (int n = hash->buckets[SpatialHash_Bucket(cx, cy)]; n >= 0; n = hash->nodes[n].next) {
+                const SpatialNode *node = &hash->nodes[n];
+                if (node->cx != cx || node->cy != cy) continue;
+
+                SpatialProxy *proxy = &hash->proxies[PHYSICS_SLOT(node->handle) - 1];
+                if (proxy->stamp == hash->stamp) continue;
+                proxy->stamp = hash->stamp;
+
+                int i = PhysicsWorld_Index(world, node->handle);
+                if (i < 0 || !(world->categories[i] & categoryMask)) continue;
+
+                if (found == maxOut) return found;
+                out[found++] = node->handle;
+            }
+        }
+    }
+    return found;
+}
+
+// Candidates for overlapping `rect`, see SpatialHash_QueryCells
+int SpatialHash_QueryRect(SpatialHash *hash, const PhysicsWorld *world, const SDL_Rect *rect, Uint32 categoryMask,
+                          BodyHandle *out, int maxOut)
+{
+    if (!hash || !world || !rect || !out || maxOut <= 0) return 0;
+
+    return SpatialHash_QueryCells(hash, world,
+                                  SpatialHash_Cell(hash, (float)rect->x), SpatialHash_Cell(hash, (float)rect->y),
+                                  SpatialHash_Cell(hash, (float)(rect->x + rect->w)),
+                                  SpatialHash_Cell(hash, (float)(rect->y + rect->h)),
+                                  categoryMask, out, maxOut);
+}
+
+// Candidates for containing the point (x, y)
+int SpatialHash_QueryPoint(SpatialHash *hash, const PhysicsWorld *world, float x, float y, Uint32 categoryMask,
+                           BodyHandle *out, int maxOut)
+{
+    if (!hash || !world || !out || maxOut <= 0) return 0;
+
+    int cx = SpatialHash_Cell(hash, x);
+    int cy = SpatialHash_Cell(hash, y);
+    return SpatialHash_QueryCells(hash, world, cx, cy, cx, cy, categoryMask, out, maxOut);
+}
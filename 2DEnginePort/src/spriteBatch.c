@@ -0,0 +1,115 @@
+#include "spriteBatch.h"
+#include "counters.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void SpriteBatch_Init(SpriteBatch *batch)
+{
+    if (!batch) return;
+    memset(batch, 0, sizeof(SpriteBatch));
+    TileBatch_Init(&batch->geometry);
+}
+
+void SpriteBatch_Begin(SpriteBatch *batch)
+{
+    if (!batch) return;
+    batch->count = 0;
+}
+
+// Queues a sprite for the next flush. Returns false if it couldn't be queued.
+bool SpriteBatch_Draw(SpriteBatch *batch, SDL_Texture *texture, const SDL_Rect *src, const SDL_Rect *dst,
+                      SDL_RendererFlip flip, int layer)
+{
+    if (!batch || !texture || !dst) return false;
+
+    if (batch->count == batch->capacity) {
+        int capacity = batch->capacity > 0 ? batch->capacity * 2 : 64;
+        Sprite *sprites = realloc(batch->sprites, sizeof(Sprite) * capacity);
+        if (!sprites) return false;
+        batch->sprites = sprites;
+        batch->capacity = capacity;
+    }
+
+    Sprite *sprite = &batch->sprites[batch->count];
+    sprite->texture = texture;
+    if (src) {
+        sprite->src = *src;
+    }
+    else {
+        sprite->src.x = sprite->src.y = 0;
+        SDL_QueryTexture(texture, NULL, NULL, &sprite->src.w, &sprite->src.h);
+    }
+    sprite->dst = *dst;
+    sprite->flip = flip;
+    sprite->layer = layer;
+    sprite->order = batch->count++;
+    return true;
+}
+
+static int SpriteBatch_Compare(const void *a, const void *b)
+{
+    const Sprite *sa = a;
+    const Sprite *sb = b;
+    if (sa->layer != sb->layer) return sa->layer < sb->layer ? -1 : 1;
+    if (sa->texture != sb->texture) return (uintptr_t)sa->texture < (uintptr_t)sb->texture ? -1 : 1;
+    return sa->order - sb->order;
+}
+
+static void SpriteBatch_DrawCopies(const Sprite *sprites, int count, SDL_Renderer *renderer)
+{
+    for (int i = 0; i < count; i++) {
+        SDL_RenderCopyEx(renderer, sprites[i].texture, &sprites[i].src, &sprites[i].dst, 0, NULL, sprites[i].flip);
+        COUNTER_DRAW(sprites[i].texture);
+    }
+}
+
+// Draws everything queued since Begin and empties the batch
+void SpriteBatch_Flush(SpriteBatch *batch, SDL_Renderer *renderer)
+{
+    if (!batch || !renderer || batch->count == 0) return;
+
+    qsort(batch->sprites, batch->count, sizeof(Sprite), SpriteBatch_Compare);
+
+    for (int start = 0; start < batch->count; ) {
+        SDL_Texture *texture = batch->sprites[start].texture;
+        int end = start + 1;
+        while (end < batch->count && batch->sprites[end].texture == texture) end++;
+
+        const Sprite *run = &batch->sprites[start];
+        int runCount = end - start;
+
+        int texW = 0, texH = 0;
+        SDL_QueryTexture(texture, NULL, NULL, &texW, &texH);
+
+        bool drawn = false;
+        if (!batch->useCopy && texW > 0 && texH > 0 && TileBatch_Reserve(&batch->geometry, runCount)) {
+            float invTexW = 1.0f / texW;
+            float invTexH = 1.0f / texH;
+
+            TileBatch_Clear(&batch->geometry);
+            for (int i = 0; i < runCount; i++) {
+                TileBatch_AddQuadFlipped(&batch->geometry, &run[i].src, &run[i].dst, invTexW, invTexH, run[i].flip);
+            }
+            drawn = TileBatch_Flush(&batch->geometry, renderer, texture);
+            if (!drawn) {
+                fprintf(stderr, "[SpriteBatch] Geometry rendering failed, falling back to SDL_RenderCopyEx\n");
+                batch->useCopy = true;
+            }
+        }
+        if (!drawn) SpriteBatch_DrawCopies(run, runCount, renderer);
+
+        start = end;
+    }
+
+    batch->count = 0;
+}
+
+void SpriteBatch_Free(SpriteBatch *batch)
+{
+    if (!batch) return;
+    free(batch->sprites);
+    TileBatch_Free(&batch->geometry);
+    memset(batch, 0, sizeof(SpriteBatch));
+}
@@ -1,65 +1,313 @@
 #include "texture.h"
+#include "imageDecoder.h"
+#include "counters.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-static TextureCacheItem *textureCache = NULL;
-static int textureCacheCount = 0;
+#define TEXTURE_CACHE_MIN_CAPACITY 64
+
+// Marks a slot whose entry was evicted, probing has to continue past it
+static CachedTexture tombstone;
+#define TOMBSTONE (&tombstone)
 
 // Loads a texture from file (no caching)
 SDL_Texture* loadTexture(const char* filepath, SDL_Renderer* renderer) {
     SDL_Surface *surface = IMG_Load(filepath);
     if (!surface) return NULL;
+    COUNTER_ADD(COUNTER_IMAGES_DECODED, 1);
     SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
     SDL_FreeSurface(surface);
     return texture;
 }
 
-// Loads a texture from file or returns cached version if already loaded
-SDL_Texture *getTextureCached(SDL_Renderer *renderer, const char *path) {
-    for (int i = 0; i < textureCacheCount; i++) {
-        if (strcmp(textureCache[i].path, path) == 0) {
-            return textureCache[i].tex;
+// FNV-1a
+static Uint32 TextureCache_Hash(const char *path) {
+    Uint32 h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)path; *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+TextureCache *TextureCache_Create(SDL_Renderer *renderer, ImageDecoder *decoder, size_t budgetBytes) {
+    TextureCache *cache = calloc(1, sizeof(TextureCache));
+    if (!cache) return NULL;
+
+    cache->renderer = renderer;
+    cache->decoder = decoder;
+    cache->budgetBytes = budgetBytes;
+    cache->capacity = TEXTURE_CACHE_MIN_CAPACITY;
+    cache->slots = calloc(cache->capacity, sizeof(CachedTexture *));
+    cache->lock = SDL_CreateMutex();
+    if (!cache->slots || !cache->lock) {
+        free(cache->slots);
+        if (cache->lock) SDL_DestroyMutex(cache->lock);
+        free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+static void TextureCache_FreeEntry(CachedTexture *entry) {
+    SDL_DestroyTexture(entry->tex);
+    free(entry->path);
+    free(entry);
+}
+
+void TextureCache_Destroy(TextureCache *cache) {
+    if (!cache) return;
+
+    for (int i = 0; i < cache->capacity; i++) {
+        CachedTexture *entry = cache->slots[i];
+        if (!entry || entry == TOMBSTONE) continue;
+        if (entry->refCount > 0) {
+            fprintf(stderr, "[TextureCache] '%s' still has %d reference(s) at shutdown\n", entry->path, entry->refCount);
         }
+        TextureCache_FreeEntry(entry);
     }
-    SDL_Texture *tex = loadTexture(path, renderer);
-    if (!tex) return NULL;
-    textureCache = realloc(textureCache, sizeof(TextureCacheItem) * (textureCacheCount + 1));
-    textureCache[textureCacheCount].path = _strdup(path);
-    textureCache[textureCacheCount].tex = tex;
-    textureCacheCount++;
-    return tex;
-}
-
-// Frees a texture and removes it from the cache if present
-void freeTexture(SDL_Texture *tex, SDL_Renderer *renderer) {
-    if (!tex) return;
-    // Remove from cache if present
-    for (int i = 0; i < textureCacheCount; i++) {
-        if (textureCache[i].tex == tex) {
-            free(textureCache[i].path);
-            // Shift remaining items
-            for (int j = i; j < textureCacheCount - 1; j++) {
-                textureCache[j] = textureCache[j + 1];
-            }
-            textureCacheCount--;
-            if (textureCacheCount == 0) {
-                free(textureCache);
-                textureCache = NULL;
-            } else {
-                textureCache = realloc(textureCache, sizeof(TextureCacheItem) * textureCacheCount);
+    free(cache->slots);
+    SDL_DestroyMutex(cache->lock);
+    free(cache);
+}
+
+// Slot holding `path`, or -1. Caller holds the lock.
+static int TextureCache_FindSlot(const TextureCache *cache, const char *path, Uint32 hash) {
+    int mask = cache->capacity - 1;
+    for (int i = (int)(hash & mask), n = 0; n < cache->capacity; i = (i + 1) & mask, n++) {
+        CachedTexture *entry = cache->slots[i];
+        if (!entry) return -1;
+        if (entry != TOMBSTONE && entry->hash == hash && strcmp(entry->path, path) == 0) return i;
+    }
+    return -1;
+}
+
+static void TextureCache_PlaceEntry(CachedTexture **slots, int capacity, CachedTexture *entry) {
+    int mask = capacity - 1;
+    int i = (int)(entry->hash & mask);
+    while (slots[i] && slots[i] != TOMBSTONE) i = (i + 1) & mask;
+    slots[i] = entry;
+}
+
+// Keeps live entries + tombstones under 70% of the table
+static bool TextureCache_Reserve(TextureCache *cache) {
+    if ((cache->count + cache->tombstones + 1) * 10 < cache->capacity * 7) return true;
+
+    int capacity = cache->capacity;
+    while ((cache->count + 1) * 10 >= capacity * 5) capacity *= 2;
+
+    CachedTexture **slots = calloc(capacity, sizeof(CachedTexture *));
+    if (!slots) return false;
+
+    for (int i = 0; i < cache->capacity; i++) {
+        CachedTexture *entry = cache->slots[i];
+        if (entry && entry != TOMBSTONE) TextureCache_PlaceEntry(slots, capacity, entry);
+    }
+    free(cache->slots);
+    cache->slots = slots;
+    cache->capacity = capacity;
+    cache->tombstones = 0;
+    return true;
+}
+
+static void TextureCache_LruUnlink(TextureCache *cache, CachedTexture *entry) {
+    if (entry->prev) entry->prev->next = entry->next;
+    else if (cache->lruHead == entry) cache->lruHead = entry->next;
+
+    if (entry->next) entry->next->prev = entry->prev;
+    else if (cache->lruTail == entry) cache->lruTail = entry->prev;
+
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+static void TextureCache_LruPushFront(TextureCache *cache, CachedTexture *entry) {
+    entry->prev = NULL;
+    entry->next = cache->lruHead;
+    if (cache->lruHead) cache->lruHead->prev = entry;
+    cache->lruHead = entry;
+    if (!cache->lruTail) cache->lruTail = entry;
+}
+
+// Only unreferenced textures are evicted, least recently released first.
+// Referenced ones can push the cache over budget, that's reported but not an error.
+static void TextureCache_Evict(TextureCache *cache) {
+    while (cache->bytesUsed > cache->budgetBytes && cache->lruTail) {
+        CachedTexture *entry = cache->lruTail;
+        TextureCache_LruUnlink(cache, entry);
+
+        int slot = TextureCache_FindSlot(cache, entry->path, entry->hash);
+        if (slot >= 0) {
+            cache->slots[slot] = TOMBSTONE;
+            cache->tombstones++;
+        }
+        cache->count--;
+        cache->bytesUsed -= entry->bytes;
+        TextureCache_FreeEntry(entry);
+    }
+}
+
+// Caller holds the lock
+static CachedTexture *TextureCache_Insert(TextureCache *cache, const char *path, Uint32 hash, SDL_Texture *tex) {
+    if (!TextureCache_Reserve(cache)) return NULL;
+
+    CachedTexture *entry = calloc(1, sizeof(CachedTexture));
+    if (!entry) return NULL;
+    entry->path = _strdup(path);
+    if (!entry->path) {
+        free(entry);
+        return NULL;
+    }
+
+    Uint32 format = 0;
+    SDL_QueryTexture(tex, &format, NULL, &entry->w, &entry->h);
+    int bpp = SDL_BYTESPERPIXEL(format);
+    entry->cache = cache;
+    entry->hash = hash;
+    entry->tex = tex;
+    entry->bytes = (size_t)entry->w * entry->h * (bpp > 0 ? bpp : 4);
+    entry->refCount = 1;
+
+    TextureCache_PlaceEntry(cache->slots, cache->capacity, entry);
+    cache->count++;
+    cache->bytesUsed += entry->bytes;
+    TextureCache_Evict(cache);
+    return entry;
+}
+
+// Caller holds the lock
+static CachedTexture *TextureCache_Ref(TextureCache *cache, int slot) {
+    CachedTexture *entry = cache->slots[slot];
+    if (entry->refCount++ == 0) TextureCache_LruUnlink(cache, entry);
+    return entry;
+}
+
+// Returns a referenced handle for `path`, loading it on a miss. Main thread only.
+CachedTexture *TextureCache_Acquire(TextureCache *cache, const char *path) {
+    if (!cache || !path) return NULL;
+
+    CachedTexture *entry = TextureCache_AcquireLoaded(cache, path);
+    if (entry) return entry;
+
+    SDL_Texture *tex = loadTexture(path, cache->renderer);
+    if (!tex) {
+        fprintf(stderr, "[TextureCache] Failed to load '%s': %s\n", path, IMG_GetError());
+        return NULL;
+    }
+    return TextureCache_Adopt(cache, path, tex);
+}
+
+// Like Acquire, but never loads: NULL if `path` isn't resident
+CachedTexture *TextureCache_AcquireLoaded(TextureCache *cache, const char *path) {
+    if (!cache || !path) return NULL;
+
+    Uint32 hash = TextureCache_Hash(path);
+    SDL_LockMutex(cache->lock);
+    int slot = TextureCache_FindSlot(cache, path, hash);
+    CachedTexture *entry = slot >= 0 ? TextureCache_Ref(cache, slot) : NULL;
+    SDL_UnlockMutex(cache->lock);
+    return entry;
+}
+
+// Hands a texture created elsewhere (the level loader's banded uploads) to the cache.
+// If `path` got cached in the meantime the existing entry wins and `tex` is destroyed.
+CachedTexture *TextureCache_Adopt(TextureCache *cache, const char *path, SDL_Texture *tex) {
+    if (!cache || !path || !tex) return NULL;
+
+    Uint32 hash = TextureCache_Hash(path);
+    SDL_LockMutex(cache->lock);
+    CachedTexture *entry = NULL;
+    int slot = TextureCache_FindSlot(cache, path, hash);
+    if (slot >= 0) {
+        entry = TextureCache_Ref(cache, slot);
+        SDL_DestroyTexture(tex);
+    } else {
+        entry = TextureCache_Insert(cache, path, hash, tex);
+        if (!entry) SDL_DestroyTexture(tex);
+    }
+    SDL_UnlockMutex(cache->lock);
+    return entry;
+}
+
+// Creates the texture for a finished decode and hands it to the cache. Main thread only.
+static CachedTexture *TextureCache_Upload(TextureCache *cache, ImageFuture *future) {
+    SDL_Surface *surf = ImageFuture_Wait(cache->decoder, future);
+    if (!surf) return NULL;
+
+    SDL_Texture *tex = SDL_CreateTextureFromSurface(cache->renderer, surf);
+    if (!tex) {
+        fprintf(stderr, "[TextureCache] Failed to create texture for '%s': %s\n", future->path, SDL_GetError());
+        return NULL;
+    }
+    return TextureCache_Adopt(cache, future->path, tex);
+}
+
+// Acquires every path in one go. Misses are all submitted to the decoder first and
+// uploaded here in whatever order they finish, so the decodes overlap each other and
+// the uploads. out[i] is NULL for a path that failed; returns false if any did.
+bool TextureCache_AcquireMany(TextureCache *cache, const char *const *paths, int count, CachedTexture **out) {
+    if (count <= 0) return true;
+    if (!cache || !paths || !out) return false;
+
+    ImageFuture **pending = calloc(count, sizeof(ImageFuture *));
+    if (!pending) return false;
+
+    int remaining = 0;
+    for (int i = 0; i < count; i++) {
+        out[i] = TextureCache_AcquireLoaded(cache, paths[i]);
+        if (!out[i] && paths[i]) {
+            pending[i] = ImageDecoder_Submit(cache->decoder, paths[i]);
+            if (pending[i]) remaining++;
+        }
+    }
+
+    while (remaining > 0) {
+        int uploaded = 0;
+        int oldest = -1;
+        for (int i = 0; i < count; i++) {
+            if (!pending[i]) continue;
+            if (!ImageFuture_IsReady(pending[i])) {
+                if (oldest < 0) oldest = i;
+                continue;
             }
-            break;
+            out[i] = TextureCache_Upload(cache, pending[i]);
+            ImageFuture_Release(pending[i]);
+            pending[i] = NULL;
+            remaining--;
+            uploaded++;
         }
+        // Nothing finished since the last pass, sleep on the oldest one still running
+        if (uploaded == 0 && oldest >= 0) ImageFuture_Wait(cache->decoder, pending[oldest]);
+    }
+    free(pending);
+
+    bool all = true;
+    for (int i = 0; i < count; i++) {
+        if (!out[i]) all = false;
     }
-    SDL_DestroyTexture(tex);
+    return all;
 }
 
-void freeAllTextures() {
-    for (int i = 0; i < textureCacheCount; i++) {
-        free(textureCache[i].path);
-        SDL_DestroyTexture(textureCache[i].tex);
+// Safe from any thread. Only a hint: the entry may be evicted right after.
+bool TextureCache_Contains(TextureCache *cache, const char *path) {
+    if (!cache || !path) return false;
+
+    Uint32 hash = TextureCache_Hash(path);
+    SDL_LockMutex(cache->lock);
+    bool found = TextureCache_FindSlot(cache, path, hash) >= 0;
+    SDL_UnlockMutex(cache->lock);
+    return found;
+}
+
+void TextureCache_Release(CachedTexture *handle) {
+    if (!handle) return;
+
+    TextureCache *cache = handle->cache;
+    SDL_LockMutex(cache->lock);
+    if (handle->refCount > 0 && --handle->refCount == 0) {
+        TextureCache_LruPushFront(cache, handle);
+        TextureCache_Evict(cache);
     }
-    free(textureCache);
-    textureCache = NULL;
-    textureCacheCount = 0;
+    SDL_UnlockMutex(cache->lock);
 }
@@ -0,0 +1,374 @@
+#include "textureAtlas.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Top edge of the packed area, one node per horizontal segment, sorted by x
+typedef struct AtlasNode {
+    int x, y, w;
+} AtlasNode;
+
+typedef struct AtlasSkyline {
+    AtlasNode *nodes;
+    int count;
+} AtlasSkyline;
+
+static int TextureAtlas_Cols(const AtlasItem *item)
+{
+    return item->cellSize > 0 ? item->w / item->cellSize : 1;
+}
+
+static int TextureAtlas_Rows(const AtlasItem *item)
+{
+    return item->cellSize > 0 ? item->h / item->cellSize : 1;
+}
+
+// Space the item takes in a page, borders included
+static void TextureAtlas_PackedSize(const AtlasItem *item, int *w, int *h)
+{
+    if (item->cellSize > 0) {
+        int stride = item->cellSize + 2 * ATLAS_PADDING;
+        *w = TextureAtlas_Cols(item) * stride;
+        *h = TextureAtlas_Rows(item) * stride;
+    } else {
+        *w = item->w + 2 * ATLAS_PADDING;
+        *h = item->h + 2 * ATLAS_PADDING;
+    }
+}
+
+static bool TextureAtlas_IsPackable(const AtlasItem *item)
+{
+    if (!item->source || item->w <= 0 || item->h <= 0) return false;
+    return TextureAtlas_Cols(item) > 0 && TextureAtlas_Rows(item) > 0;
+}
+
+// Tallest first, then widest, keeps the skyline flat
+static int TextureAtlas_CompareItems(const void *a, const void *b)
+{
+    int aw, ah, bw, bh;
+    TextureAtlas_PackedSize(*(const AtlasItem *const *)a, &aw, &ah);
+    TextureAtlas_PackedSize(*(const AtlasItem *const *)b, &bw, &bh);
+    if (ah != bh) return bh - ah;
+    return bw - aw;
+}
+
+// y the rect would sit at when its left edge is at node `index`, -1 if it doesn't fit
+static int TextureAtlas_SkylineFit(const AtlasSkyline *sky, int index, int w, int h, int size)
+{
+    int x = sky->nodes[index].x;
+    if (x + w > size) return -1;
+
+    int y = 0;
+    int remaining = w;
+    for (int i = index; remaining > 0; i++) {
+        if (i >= sky->count) return -1;
+        if (sky->nodes[i].y > y) y = sky->nodes[i].y;
+        if (y + h > size) return -1;
+        remaining -= sky->nodes[i].w;
+    }
+    return y;
+}
+
+// Finds the lowest spot for a w x h rect and raises the skyline over it
+static bool TextureAtlas_SkylinePack(AtlasSkyline *sky, int w, int h, int size, int *outX, int *outY)
+{
+    int best = -1, bestY = 0, bestWidth = 0;
+    for (int i = 0; i < sky->count; i++) {
+        int y = TextureAtlas_SkylineFit(sky, i, w, h, size);
+        if (y < 0) continue;
+        if (best < 0 || y + h < bestY + h || (y == bestY && sky->nodes[i].w < bestWidth)) {
+            best = i;
+            bestY = y;
+            bestWidth = sky->nodes[i].w;
+        }
+    }
+    if (best < 0) return false;
+
+    *outX = sky->nodes[best].x;
+    *outY = bestY;
+
+    // New segment on top of the rect, then trim the segments it now covers
+    memmove(&sky->nodes[best + 1], &sky->nodes[best], (sky->count - best) * sizeof(AtlasNode));
+    sky->nodes[best] = (AtlasNode){ *outX, bestY + h, w };
+    sky->count++;
+
+    int right = *outX + w;
+    int i = best + 1;
+    while (i < sky->count && sky->nodes[i].x < right) {
+        int shrink = right - sky->nodes[i].x;
+        sky->nodes[i].x += shrink;
+        sky->nodes[i].w -= shrink;
+        if (sky->nodes[i].w > 0) break;
+        memmove(&sky->nodes[i], &sky->nodes[i + 1], (sky->count - i - 1) * sizeof(AtlasNode));
+        sky->count--;
+    }
+
+    // Neighbours at the same height become one segment
+    for (i = 0; i + 1 < sky->count; ) {
+        if (sky->nodes[i].y == sky->nodes[i + 1].y) {
+            sky->nodes[i].w += sky->nodes[i + 1].w;
+            memmove(&sky->nodes[i + 1], &sky->nodes[i + 2], (sky->count - i - 2) * sizeof(AtlasNode));
+            sky->count--;
+        } else {
+            i++;
+        }
+    }
+    return true;
+}
+
+// Places every item on pages of `size`. Returns the number of pages used, -1 on failure.
+static int TextureAtlas_PackAll(AtlasItem **order, int count, int size)
+{
+    // Every pack adds at most one node, so a page never needs more than count + 1
+    AtlasSkyline *pages = NULL;
+    AtlasNode *nodes = NULL;
+    int pageCount = 0;
+
+    for (int k = 0; k < count; k++) {
+        AtlasItem *item = order[k];
+        int w, h;
+        TextureAtlas_PackedSize(item, &w, &h);
+        item->page = -1;
+        if (w > size || h > size) continue;
+
+        int x = 0, y = 0;
+        for (int p = 0; p < pageCount && item->page < 0; p++) {
+            if (TextureAtlas_SkylinePack(&pages[p], w, h, size, &x, &y)) item->page = p;
+        }
+
+        if (item->page < 0) {
+            AtlasSkyline *grownPages = realloc(pages, (pageCount + 1) * sizeof(AtlasSkyline));
+            AtlasNode *grownNodes = realloc(nodes, (size_t)(pageCount + 1) * (count + 1) * sizeof(AtlasNode));
+            if (grownPages) pages = grownPages;
+            if (grownNodes) nodes = grownNodes;
+            if (!grownPages || !grownNodes) {
+                free(pages);
+                free(nodes);
+                return -1;
+            }
+
+            pageCount++;
+            for (int p = 0; p < pageCount; p++) {
+                pages[p].nodes = &nodes[(size_t)p * (count + 1)];
+            }
+            pages[pageCount - 1].nodes[0] = (AtlasNode){ 0, 0, size };
+            pages[pageCount - 1].count = 1;
+
+            TextureAtlas_SkylinePack(&pages[pageCount - 1], w, h, size, &x, &y);
+            item->page = pageCount - 1;
+        }
+
+        item->x = x + ATLAS_PADDING;
+        item->y = y + ATLAS_PADDING;
+        item->stride = item->cellSize > 0 ? item->cellSize + 2 * ATLAS_PADDING : 0;
+    }
+
+    free(pages);
+    free(nodes);
+    return pageCount;
+}
+
+// One cell (or a whole image) plus its border: the body, then the edge rows and
+// columns stretched over the padding, then the corner pixels
+static void TextureAtlas_DrawExtruded(SDL_Renderer *renderer, SDL_Texture *source,
+                                      const SDL_Rect *src, int dx, int dy, bool extrude)
+{
+    SDL_Rect dst = { dx, dy, src->w, src->h };
+    SDL_RenderCopy(renderer, source, src, &dst);
+    if (!extrude || ATLAS_PADDING == 0) return;
+
+    const int p = ATLAS_PADDING;
+    int right = src->x + src->w - 1;
+    int bottom = src->y + src->h - 1;
+
+    SDL_Rect edges[8][2] = {
+        { { src->x, src->y, src->w, 1 },  { dx, dy - p, src->w, p } },
+        { { src->x, bottom, src->w, 1 },  { dx, dy + src->h, src->w, p } },
+        { { src->x, src->y, 1, src->h },  { dx - p, dy, p, src->h } },
+        { { right, src->y, 1, src->h },   { dx + src->w, dy, p, src->h } },
+        { { src->x, src->y, 1, 1 },       { dx - p, dy - p, p, p } },
+        { { right, src->y, 1, 1 },        { dx + src->w, dy - p, p, p } },
+        { { src->x, bottom, 1, 1 },       { dx - p, dy + src->h, p, p } },
+        { { right, bottom, 1, 1 },        { dx + src->w, dy + src->h, p, p } },
+    };
+    for (int i = 0; i < 8; i++) {
+        SDL_RenderCopy(renderer, source, &edges[i][0], &edges[i][1]);
+    }
+}
+
+// Packs the items and draws the pages. Placement is written back into `items`;
+// returns NULL (and every item unpacked) when render targets aren't available.
+TextureAtlas *TextureAtlas_Create(SDL_Renderer *renderer, AtlasItem *items, int count)
+{
+    if (!renderer || !items || count <= 0) return NULL;
+
+    for (int i = 0; i < count; i++) items[i].page = -1;
+
+    if (!SDL_RenderTargetSupported(renderer)) {
+        fprintf(stderr, "[Atlas] Render targets not supported, textures stay separate\n");
+        return NULL;
+    }
+
+    SDL_RendererInfo info;
+    int maxSize = ATLAS_MAX_PAGE;
+    if (SDL_GetRendererInfo(renderer, &info) == 0) {
+        if (info.max_texture_width > 0 && info.max_texture_width < maxSize) maxSize = info.max_texture_width;
+        if (info.max_texture_height > 0 && info.max_texture_height < maxSize) maxSize = info.max_texture_height;
+    }
+
+    AtlasItem **order = malloc(count * sizeof(AtlasItem *));
+    if (!order) return NULL;
+
+    int packable = 0;
+    long long area = 0;
+    int largest = 0;
+    for (int i = 0; i < count; i++) {
+        if (!TextureAtlas_IsPackable(&items[i])) continue;
+        int w, h;
+        TextureAtlas_PackedSize(&items[i], &w, &h);
+        if (w > maxSize || h > maxSize) {
+            fprintf(stderr, "[Atlas] %dx%d image doesn't fit in a %dx%d page, left as is\n", items[i].w, items[i].h, maxSize, maxSize);
+            continue;
+        }
+        area += (long long)w * h;
+        if (w > largest) largest = w;
+        if (h > largest) largest = h;
+        order[packable++] = &items[i];
+    }
+    if (packable == 0) {
+        free(order);
+        return NULL;
+    }
+    qsort(order, packable, sizeof(AtlasItem *), TextureAtlas_CompareItems);
+
+    // Smallest power of two page that could hold everything, doubled until one page
+    // does or the size limit is reached; past that the items spread over more pages
+    int size = ATLAS_MIN_PAGE;
+    while (size < maxSize && ((long long)size * size < area || size < largest)) size *= 2;
+    if (size > maxSize) size = maxSize;
+
+    int pageCount;
+    for (;;) {
+        pageCount = TextureAtlas_PackAll(order, packable, size);
+        if (pageCount < 0) {
+            free(order);
+            return NULL;
+        }
+        if (pageCount <= 1 || size * 2 > maxSize) break;
+        size *= 2;
+    }
+    free(order);
+
+    if (pageCount == 0) {
+        fprintf(stderr, "[Atlas] Nothing fits in a %dx%d page\n", size, size);
+        return NULL;
+    }
+
+    TextureAtlas *atlas = calloc(1, sizeof(TextureAtlas));
+    if (!atlas) return NULL;
+    atlas->renderer = renderer;
+    atlas->pageSize = size;
+    atlas->pageCount = pageCount;
+    atlas->pages = calloc(pageCount, sizeof(SDL_Texture *));
+    atlas->items = malloc(count * sizeof(AtlasItem));
+    atlas->itemCount = count;
+    if (!atlas->pages || !atlas->items) {
+        TextureAtlas_Destroy(atlas);
+        for (int i = 0; i < count; i++) items[i].page = -1;
+        return NULL;
+    }
+    memcpy(atlas->items, items, count * sizeof(AtlasItem));
+
+    for (int p = 0; p < pageCount; p++) {
+        atlas->pages[p] = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, size, size);
+        if (!atlas->pages[p]) {
+            fprintf(stderr, "[Atlas] Failed to create %dx%d page: %s\n", size, size, SDL_GetError());
+            TextureAtlas_Destroy(atlas);
+            for (int i = 0; i < count; i++) items[i].page = -1;
+            return NULL;
+        }
+        SDL_SetTextureBlendMode(atlas->pages[p], SDL_BLENDMODE_BLEND);
+    }
+
+    if (!TextureAtlas_Redraw(atlas)) {
+        TextureAtlas_Destroy(atlas);
+        for (int i = 0; i < count; i++) items[i].page = -1;
+        return NULL;
+    }
+
+    fprintf(stderr, "[Atlas] Packed %d images into %d page(s) of %dx%d\n", packable, pageCount, size, size);
+    return atlas;
+}
+
+// Draws every page from its sources again, after creation or a render target reset
+bool TextureAtlas_Redraw(TextureAtlas *atlas)
+{
+    if (!atlas) return false;
+
+    SDL_Renderer *renderer = atlas->renderer;
+    SDL_Texture *prevTarget = SDL_GetRenderTarget(renderer);
+    float scaleX, scaleY;
+    SDL_RenderGetScale(renderer, &scaleX, &scaleY);
+    SDL_BlendMode prevDrawBlend;
+    SDL_GetRenderDrawBlendMode(renderer, &prevDrawBlend);
+
+    bool ok = true;
+    for (int p = 0; p < atlas->pageCount && ok; p++) {
+        if (SDL_SetRenderTarget(renderer, atlas->pages[p]) != 0) {
+            fprintf(stderr, "[Atlas] Failed to draw page %d: %s\n", p, SDL_GetError());
+            ok = false;
+            break;
+        }
+        SDL_RenderSetScale(renderer, 1.0f, 1.0f);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+
+        for (int i = 0; i < atlas->itemCount; i++) {
+            const AtlasItem *item = &atlas->items[i];
+            if (item->page != p) continue;
+
+            // Copy alpha as is instead of blending it onto the cleared page
+            SDL_BlendMode sourceBlend;
+            SDL_GetTextureBlendMode(item->source, &sourceBlend);
+            SDL_SetTextureBlendMode(item->source, SDL_BLENDMODE_NONE);
+
+            if (item->cellSize > 0) {
+                int cols = TextureAtlas_Cols(item);
+                int rows = TextureAtlas_Rows(item);
+                for (int r = 0; r < rows; r++) {
+                    for (int c = 0; c < cols; c++) {
+                        SDL_Rect src = { c * item->cellSize, r * item->cellSize, item->cellSize, item->cellSize };
+                        TextureAtlas_DrawExtruded(renderer, item->source, &src,
+                                                  item->x + c * item->stride, item->y + r * item->stride, true);
+                    }
+                }
+            } else {
+                SDL_Rect src = { 0, 0, item->w, item->h };
+                TextureAtlas_DrawExtruded(renderer, item->source, &src, item->x, item->y, false);
+            }
+
+            SDL_SetTextureBlendMode(item->source, sourceBlend);
+        }
+    }
+
+    SDL_SetRenderTarget(renderer, prevTarget);
+    SDL_RenderSetScale(renderer, scaleX, scaleY);
+    SDL_SetRenderDrawBlendMode(renderer, prevDrawBlend);
+    return ok;
+}
+
+void TextureAtlas_Destroy(TextureAtlas *atlas)
+{
+    if (!atlas) return;
+
+    if (atlas->pages) {
+        for (int p = 0; p < atlas->pageCount; p++) {
+            if (atlas->pages[p]) SDL_DestroyTexture(atlas->pages[p]);
+        }
+    }
+    free(atlas->pages);
+    free(atlas->items);
+    free(atlas);
+}
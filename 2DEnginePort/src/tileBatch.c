@@ -0,0 +1,120 @@
+#include "tileBatch.h"
+#include "counters.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void TileBatch_Init(TileBatch *batch)
+{
+    if (!batch) return;
+    memset(batch, 0, sizeof(TileBatch));
+}
+
+// Makes sure at least quadCount quads fit. Existing contents are kept.
+bool TileBatch_Reserve(TileBatch *batch, int quadCount)
+{
+    if (!batch) return false;
+    if (quadCount <= batch->quadCapacity) return true;
+
+    // grow geometrically so a slowly growing view doesn't realloc every frame
+    int newCapacity = batch->quadCapacity > 0 ? batch->quadCapacity : 256;
+    while (newCapacity < quadCount) newCapacity *= 2;
+
+    SDL_Vertex *vertices = realloc(batch->vertices, sizeof(SDL_Vertex) * 4 * newCapacity);
+    if (!vertices) return false;
+    batch->vertices = vertices;
+
+    int *indices = realloc(batch->indices, sizeof(int) * 6 * newCapacity);
+    if (!indices) return false;
+    batch->indices = indices;
+
+    // Index pattern never changes, only fill in the new part
+    for (int q = batch->quadCapacity; q < newCapacity; q++) {
+        int v = q * 4;
+        int *idx = &batch->indices[q * 6];
+        idx[0] = v;     idx[1] = v + 1; idx[2] = v + 2;
+        idx[3] = v + 2; idx[4] = v + 3; idx[5] = v;
+    }
+
+    batch->quadCapacity = newCapacity;
+    return true;
+}
+
+void TileBatch_Clear(TileBatch *batch)
+{
+    if (!batch) return;
+    batch->quadCount = 0;
+}
+
+static void TileBatch_WriteQuad(TileBatch *batch, const SDL_Rect *dst, float u0, float v0, float u1, float v1)
+{
+    SDL_Vertex *v = &batch->vertices[batch->quadCount * 4];
+
+    float x0 = (float)dst->x;
+    float y0 = (float)dst->y;
+    float x1 = (float)(dst->x + dst->w);
+    float y1 = (float)(dst->y + dst->h);
+
+    SDL_Color white = { 255, 255, 255, 255 };
+
+    v[0].position.x = x0; v[0].position.y = y0; v[0].color = white; v[0].tex_coord.x = u0; v[0].tex_coord.y = v0;
+    v[1].position.x = x1; v[1].position.y = y0; v[1].color = white; v[1].tex_coord.x = u1; v[1].tex_coord.y = v0;
+    v[2].position.x = x1; v[2].position.y = y1; v[2].color = white; v[2].tex_coord.x = u1; v[2].tex_coord.y = v1;
+    v[3].position.x = x0; v[3].position.y = y1; v[3].color = white; v[3].tex_coord.x = u0; v[3].tex_coord.y = v1;
+
+    batch->quadCount++;
+}
+
+// Caller must have reserved room for the quad
+void TileBatch_AddQuad(TileBatch *batch, const SDL_Rect *src, const SDL_Rect *dst, float invTexW, float invTexH)
+{
+    TileBatch_WriteQuad(batch, dst,
+                        src->x * invTexW, src->y * invTexH,
+                        (src->x + src->w) * invTexW, (src->y + src->h) * invTexH);
+}
+
+// Same as TileBatch_AddQuad, mirrored by swapping the texture coordinates instead of the corners
+void TileBatch_AddQuadFlipped(TileBatch *batch, const SDL_Rect *src, const SDL_Rect *dst, float invTexW, float invTexH,
+                              SDL_RendererFlip flip)
+{
+    float u0 = src->x * invTexW;
+    float v0 = src->y * invTexH;
+    float u1 = (src->x + src->w) * invTexW;
+    float v1 = (src->y + src->h) * invTexH;
+
+    if (flip & SDL_FLIP_HORIZONTAL) { float t = u0; u0 = u1; u1 = t; }
+    if (flip & SDL_FLIP_VERTICAL)   { float t = v0; v0 = v1; v1 = t; }
+
+    TileBatch_WriteQuad(batch, dst, u0, v0, u1, v1);
+}
+
+// Submits everything collected so far in one call and clears the batch.
+// Returns false if the renderer rejected the geometry, so the caller can fall back to SDL_RenderCopy.
+bool TileBatch_Flush(TileBatch *batch, SDL_Renderer *renderer, SDL_Texture *tex)
+{
+    if (!batch || !renderer) return false;
+    if (batch->quadCount == 0) return true;
+
+    bool ok = false;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    ok = SDL_RenderGeometry(renderer, tex,
+                            batch->vertices, batch->quadCount * 4,
+                            batch->indices, batch->quadCount * 6) == 0;
+    COUNTER_DRAW(tex);
+    if (!ok) {
+        fprintf(stderr, "[TileBatch] SDL_RenderGeometry failed: %s\n", SDL_GetError());
+    }
+#endif
+
+    batch->quadCount = 0;
+    return ok;
+}
+
+void TileBatch_Free(TileBatch *batch)
+{
+    if (!batch) return;
+    free(batch->vertices);
+    free(batch->indices);
+    memset(batch, 0, sizeof(TileBatch));
+}
@@ -3,9 +3,30 @@
 #include "player.h"
 #include "gameManager.h"
 #include "level.h"
+#include "profiler.h"
+#include "physicsWorld.h"
+#include "spatialHash.h"
 
 void Update(GameManager *gm)
 {
+    PROFILE_BEGIN("Camera_Update");
     Camera_Update(&gm->camera, gm->player, gm->level);
+    PROFILE_END();
+
+    PROFILE_BEGIN("Player_Update");
     Player_Update(gm->player, gm->deltaTime, gm->level);
+    PROFILE_END();
+
+    PROFILE_BEGIN("PhysicsWorld_Step");
+    PhysicsWorld_Step(gm->physics, gm->level, gm->deltaTime, gm->jobs);
+    PROFILE_END();
+
+    // Only bodies that crossed into other cells are re-inserted
+    PROFILE_BEGIN("SpatialHash_Sync");
+    SpatialHash_Sync(gm->broadphase, gm->physics);
+    PROFILE_END();
+
+    PROFILE_BEGIN("Player_AfterPhysics");
+    Player_AfterPhysics(gm->player, gm->deltaTime, gm->level);
+    PROFILE_END();
 }
\ No newline at end of file
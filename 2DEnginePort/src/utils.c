@@ -1,4 +1,5 @@
 #include "utils.h"
+#include "counters.h"
 
 char *read_whole_file(const char *path)
 {
@@ -9,8 +10,9 @@ char *read_whole_file(const char *path)
     rewind(f);
     char *buf = malloc(size + 1);
     if (!buf) { fclose(f); return NULL; }
-    fread(buf, 1, size, f);
-    buf[size] = '\0';
+    size_t read = fread(buf, 1, size, f);
+    COUNTER_ADD(COUNTER_BYTES_READ, read);
+    buf[read] = '\0';   // short reads end the string early
     fclose(f);
     return buf;
 }
\ No newline at end of file
@@ -0,0 +1,136 @@
+// Microbenchmark for the tile CSV parser.
+// Builds a synthetic 4096 x 512 layer (Tiled style: -1 for empty, small tile ids)
+// and reports parse throughput for the in-memory parser, the file parser and the
+// old fgets/strtok/atoi loop (given a line buffer big enough to hold a row).
+//
+// Usage: csvBench [iterations]
+// Builds from tools/csvBench.c and src/csvParser.c (`make build/csvBench`), no SDL needed.
+
+#include "csvParser.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_COLS 4096
+#define BENCH_ROWS 512
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Fixed-seed xorshift so every run parses the same data
+static unsigned int rngState = 0x2D3E4F5Au;
+static unsigned int rngNext(void)
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static char *buildCSV(size_t *outSize)
+{
+    size_t cap = (size_t)BENCH_ROWS * BENCH_COLS * 5 + BENCH_ROWS * 2;
+    char *buf = malloc(cap);
+    if (!buf) return NULL;
+
+    char *p = buf;
+    for (int r = 0; r < BENCH_ROWS; r++) {
+        for (int c = 0; c < BENCH_COLS; c++) {
+            unsigned int roll = rngNext() % 100;
+            int tile = roll < 60 ? -1 : (int)(rngNext() % 256);
+            p += sprintf(p, c + 1 < BENCH_COLS ? "%d," : "%d", tile);
+        }
+        *p++ = '\r';
+        *p++ = '\n';
+    }
+    *outSize = (size_t)(p - buf);
+    return buf;
+}
+
+// The loop loadLayerCSV used to run, minus the 1024 byte line limit
+static void parseLegacy(const char *path, int rows, int cols, int *tiles)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) return;
+    size_t lineSize = (size_t)cols * 12 + 16;
+    char *line = malloc(lineSize);
+    int row = 0;
+    while (line && fgets(line, (int)lineSize, f) && row < rows) {
+        char *token = strtok(line, ",");
+        int col = 0;
+        while (token && col < cols) {
+            tiles[row * cols + col] = atoi(token);
+            token = strtok(NULL, ",");
+            col++;
+        }
+        row++;
+    }
+    free(line);
+    fclose(f);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 20;
+    if (iterations < 1) iterations = 1;
+
+    size_t size = 0;
+    char *csv = buildCSV(&size);
+    int *tiles = malloc(sizeof(int) * BENCH_ROWS * BENCH_COLS);
+    if (!csv || !tiles) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    const char *path = "csvBench_tmp.csv";
+    FILE *f = fopen(path, "wb");
+    if (!f || fwrite(csv, 1, size, f) != size) {
+        fprintf(stderr, "failed to write %s\n", path);
+        return EXIT_FAILURE;
+    }
+    fclose(f);
+
+    double mb = size / (1024.0 * 1024.0);
+    printf("Layer %d x %d, %.2f MB, %d iterations\n", BENCH_COLS, BENCH_ROWS, mb, iterations);
+
+    CsvResult result;
+    double t0 = nowSeconds();
+    for (int i = 0; i < iterations; i++) {
+        if (CSV_ParseTilesBuffer(csv, size, BENCH_ROWS, BENCH_COLS, tiles, &result) != CSV_OK) {
+            fprintf(stderr, "buffer parse failed: %s at row %d col %d\n",
+                    CSV_StatusString(result.status), result.row, result.column);
+            return EXIT_FAILURE;
+        }
+    }
+    double tBuffer = (nowSeconds() - t0) / iterations;
+
+    t0 = nowSeconds();
+    for (int i = 0; i < iterations; i++) {
+        if (CSV_ParseTiles(path, BENCH_ROWS, BENCH_COLS, tiles, &result) != CSV_OK) {
+            fprintf(stderr, "file parse failed: %s\n", CSV_StatusString(result.status));
+            return EXIT_FAILURE;
+        }
+    }
+    double tFile = (nowSeconds() - t0) / iterations;
+
+    t0 = nowSeconds();
+    for (int i = 0; i < iterations; i++) {
+        parseLegacy(path, BENCH_ROWS, BENCH_COLS, tiles);
+    }
+    double tLegacy = (nowSeconds() - t0) / iterations;
+
+    printf("CSV_ParseTilesBuffer : %8.3f ms  %8.1f MB/s\n", tBuffer * 1000.0, mb / tBuffer);
+    printf("CSV_ParseTiles (file): %8.3f ms  %8.1f MB/s\n", tFile * 1000.0, mb / tFile);
+    printf("fgets/strtok/atoi    : %8.3f ms  %8.1f MB/s\n", tLegacy * 1000.0, mb / tLegacy);
+
+    remove(path);
+    free(tiles);
+    free(csv);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,459 @@
+// Headless, deterministic benchmark of the real game loop.
+// Creates the GameManager on SDL's dummy video driver with the software renderer, loads
+// a level from levelPaths.json and runs N frames of exactly one simulation step each,
+// with the player driven by a scripted input file instead of the keyboard. Writes JSON
+// with min/median/p99/max per profiler phase, per frame counter (draw calls, texture
+// switches, tiles, collision probes, ...) and heap allocations per frame.
+//
+// Usage: headlessBench [--level name] [--frames N] [--warmup N] [--input script.txt]
+//                      [--settings settings.json] [--out bench.json]
+//
+// Input script, one line per change, keys stay held until the next line:
+//     # frame  actions (left right jump attack crouch dash, or "none")
+//     0        right
+//     90       right jump
+//     100      right
+//
+// Linux only. Run it from the game's working directory, like the game itself. Built by
+// the Makefile next to the Visual Studio project (`make build/headlessBench`, or
+// `make bench` to build and run it). tools/benchInput.txt is a ready-made input script.
+
+#define SDL_MAIN_HANDLED
+#include "gameManager.h"
+#include "player.h"
+#include "profiler.h"
+#include "counters.h"
+#include "cJSON.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef ENGINE_PROFILE
+#error "headlessBench needs -DENGINE_PROFILE, the phase timings and counters come from the profiler"
+#endif
+
+#define BENCH_MAX_PHASES 64
+
+// --- Heap allocations ---------------------------------------------------------
+// Defining malloc and friends here interposes them for the whole process (SDL and the
+// worker threads included); glibc's own versions stay reachable as __libc_*.
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static unsigned long long allocCount;
+static unsigned long long allocBytes;
+
+static void countAllocation(size_t size)
+{
+    __atomic_fetch_add(&allocCount, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&allocBytes, size, __ATOMIC_RELAXED);
+}
+
+void *malloc(size_t size)
+{
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    countAllocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+// --- Input script -------------------------------------------------------------
+
+enum {
+    ACTION_LEFT   = 1 << 0,
+    ACTION_RIGHT  = 1 << 1,
+    ACTION_JUMP   = 1 << 2,
+    ACTION_ATTACK = 1 << 3,
+    ACTION_CROUCH = 1 << 4,
+    ACTION_DASH   = 1 << 5,
+};
+
+typedef struct {
+    int frame;
+    unsigned actions;
+} ScriptEntry;
+
+typedef struct {
+    ScriptEntry *entries;
+    int count, capacity;
+    int next;
+    unsigned held;
+} InputScript;
+
+static bool parseAction(const char *word, unsigned *actions)
+{
+    static const struct { const char *name; unsigned bit; } names[] = {
+        {"left", ACTION_LEFT}, {"right", ACTION_RIGHT}, {"jump", ACTION_JUMP},
+        {"attack", ACTION_ATTACK}, {"crouch", ACTION_CROUCH}, {"dash", ACTION_DASH},
+        {"none", 0}, {"-", 0},
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(word, names[i].name) == 0) {
+            *actions |= names[i].bit;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool loadScript(InputScript *script, const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "[Bench] Failed to open input script '%s'\n", path);
+        return false;
+    }
+
+    char line[256];
+    int lineNumber = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        char *word = strtok(line, " \t\r\n");
+        if (!word) continue;
+
+        ScriptEntry entry = {atoi(word), 0};
+        while ((word = strtok(NULL, " \t\r\n"))) {
+            if (!parseAction(word, &entry.actions)) {
+                fprintf(stderr, "[Bench] %s:%d: unknown action '%s'\n", path, lineNumber, word);
+                ok = false;
+            }
+        }
+        if (script->count > 0 && entry.frame < script->entries[script->count - 1].frame) {
+            fprintf(stderr, "[Bench] %s:%d: frames must be in order\n", path, lineNumber);
+            ok = false;
+        }
+
+        if (script->count == script->capacity) {
+            int capacity = script->capacity ? script->capacity * 2 : 64;
+            ScriptEntry *grown = realloc(script->entries, capacity * sizeof(ScriptEntry));
+            if (!grown) {
+                ok = false;
+                break;
+            }
+            script->entries = grown;
+            script->capacity = capacity;
+        }
+        script->entries[script->count++] = entry;
+    }
+    fclose(file);
+    return ok;
+}
+
+// Keyboard state for `frame`, indexed by scancode like SDL_GetKeyboardState
+static void scriptKeys(InputScript *script, int frame, const Controls *controls, Uint8 *keys)
+{
+    while (script->next < script->count && script->entries[script->next].frame <= frame) {
+        script->held = script->entries[script->next++].actions;
+    }
+
+    memset(keys, 0, SDL_NUM_SCANCODES);
+    if (script->held & ACTION_LEFT)   keys[controls->moveLeft] = 1;
+    if (script->held & ACTION_RIGHT)  keys[controls->moveRight] = 1;
+    if (script->held & ACTION_JUMP)   keys[controls->jump] = 1;
+    if (script->held & ACTION_ATTACK) keys[controls->attack] = 1;
+    if (script->held & ACTION_CROUCH) keys[controls->crouch] = 1;
+    if (script->held & ACTION_DASH)   keys[controls->dash] = 1;
+}
+
+// --- Statistics ---------------------------------------------------------------
+
+typedef struct {
+    const char *name;
+    int depth;
+    double *samples;        // one per measured frame the phase ran in
+    int count;
+} Phase;
+
+typedef struct {
+    Phase phases[BENCH_MAX_PHASES];
+    int phaseCount;
+    int capacity;           // measured frames
+    double *counters[COUNTERS_MAX];
+    Uint64 startupCounters[COUNTERS_MAX];
+    double *allocations;
+    double *allocatedBytes;
+    int frames;
+} BenchResults;
+
+static int compareDouble(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static cJSON *statsToJSON(cJSON *parent, const char *name, double *samples, int count)
+{
+    cJSON *stats = name ? cJSON_AddObjectToObject(parent, name) : cJSON_CreateObject();
+    if (!stats || count == 0) return stats;
+
+    double total = 0.0;
+    for (int i = 0; i < count; i++) total += samples[i];
+    qsort(samples, count, sizeof(double), compareDouble);
+
+    cJSON_AddNumberToObject(stats, "min", samples[0]);
+    cJSON_AddNumberToObject(stats, "median", samples[count / 2]);
+    cJSON_AddNumberToObject(stats, "p99", samples[(count * 99) / 100]);
+    cJSON_AddNumberToObject(stats, "max", samples[count - 1]);
+    cJSON_AddNumberToObject(stats, "mean", total / count);
+    cJSON_AddNumberToObject(stats, "samples", count);
+    return stats;
+}
+
+static Phase *findPhase(BenchResults *results, const char *name, int depth)
+{
+    for (int i = 0; i < results->phaseCount; i++) {
+        if (strcmp(results->phases[i].name, name) == 0) return &results->phases[i];
+    }
+    if (results->phaseCount == BENCH_MAX_PHASES) return NULL;
+
+    Phase *phase = &results->phases[results->phaseCount];
+    phase->samples = calloc(results->capacity, sizeof(double));
+    if (!phase->samples) return NULL;
+    phase->name = name;
+    phase->depth = depth;
+    results->phaseCount++;
+    return phase;
+}
+
+// Scopes that run several times in a frame (one per simulation step) are summed
+static void recordFrame(BenchResults *results, const ProfileFrame *frame)
+{
+    double sums[BENCH_MAX_PHASES] = {0};
+    bool seen[BENCH_MAX_PHASES] = {false};
+
+    Phase *total = findPhase(results, "Frame", -1);
+    if (total) total->samples[total->count++] = Profiler_TicksToMs(frame->end - frame->start);
+
+    for (int i = 0; i < frame->count; i++) {
+        const ProfileScope *scope = &frame->scopes[i];
+        if (!scope->name || scope->end < scope->start) continue;
+
+        Phase *phase = findPhase(results, scope->name, scope->depth);
+        if (!phase) continue;
+        int index = (int)(phase - results->phases);
+        sums[index] += Profiler_TicksToMs(scope->end - scope->start);
+        seen[index] = true;
+    }
+
+    for (int i = 0; i < results->phaseCount; i++) {
+        if (seen[i]) results->phases[i].samples[results->phases[i].count++] = sums[i];
+    }
+}
+
+static bool writeResults(BenchResults *results, const char *path, const char *level, int warmup, double dt)
+{
+    cJSON *root = cJSON_CreateObject();
+    if (!root) return false;
+
+    cJSON_AddStringToObject(root, "level", level);
+    cJSON_AddNumberToObject(root, "frames", results->frames);
+    cJSON_AddNumberToObject(root, "warmup", warmup);
+    cJSON_AddNumberToObject(root, "dt", dt);
+
+    // Startup phases, GameManager_Create and the level load, in milliseconds
+    cJSON *startup = cJSON_AddObjectToObject(root, "startupMs");
+    const ProfileFrame *startupFrame = Profiler_StartupFrame();
+    for (int i = 0; startupFrame && i < startupFrame->count; i++) {
+        const ProfileScope *scope = &startupFrame->scopes[i];
+        if (scope->end < scope->start) continue;
+        cJSON_AddNumberToObject(startup, scope->name, Profiler_TicksToMs(scope->end - scope->start));
+    }
+
+    // Frame phases in milliseconds, in the order the profiler first saw them
+    cJSON *phases = cJSON_AddArrayToObject(root, "phasesMs");
+    for (int i = 0; i < results->phaseCount; i++) {
+        Phase *phase = &results->phases[i];
+        cJSON *stats = statsToJSON(NULL, NULL, phase->samples, phase->count);
+        if (!stats) continue;
+        cJSON_AddStringToObject(stats, "name", phase->name);
+        cJSON_AddNumberToObject(stats, "depth", phase->depth);
+        cJSON_AddItemToArray(phases, stats);
+    }
+
+    // Engine counters per frame, plus what startup and the level load did
+    cJSON *counters = cJSON_AddObjectToObject(root, "counters");
+    for (int i = 0; i < Counters_Count(); i++) {
+        cJSON *stats = statsToJSON(counters, Counters_Name(i), results->counters[i], results->frames);
+        if (stats) cJSON_AddNumberToObject(stats, "startup", (double)results->startupCounters[i]);
+    }
+
+    statsToJSON(root, "allocations", results->allocations, results->frames);
+    statsToJSON(root, "allocatedBytes", results->allocatedBytes, results->frames);
+
+    char *text = cJSON_Print(root);
+    cJSON_Delete(root);
+    if (!text) return false;
+
+    bool ok = false;
+    FILE *file = path ? fopen(path, "w") : stdout;
+    if (file) {
+        ok = fputs(text, file) >= 0 && fputc('\n', file) != EOF;
+        if (file != stdout && fclose(file) != 0) ok = false;
+    }
+    if (!ok) fprintf(stderr, "[Bench] Failed to write results to '%s'\n", path ? path : "stdout");
+    free(text);
+    return ok;
+}
+
+static void freeResults(BenchResults *results)
+{
+    for (int i = 0; i < results->phaseCount; i++) free(results->phases[i].samples);
+    for (int i = 0; i < COUNTERS_MAX; i++) free(results->counters[i]);
+    free(results->allocations);
+    free(results->allocatedBytes);
+}
+
+// --- Main ---------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    const char *levelName = NULL;
+    const char *inputPath = NULL;
+    const char *settingsPath = "settings.json";
+    const char *outPath = NULL;
+    int frames = 600;
+    int warmup = 60;
+
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value) {
+            fprintf(stderr, "Missing value for %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        if (strcmp(argv[i], "--level") == 0) levelName = value;
+        else if (strcmp(argv[i], "--frames") == 0) frames = atoi(value);
+        else if (strcmp(argv[i], "--warmup") == 0) warmup = atoi(value);
+        else if (strcmp(argv[i], "--input") == 0) inputPath = value;
+        else if (strcmp(argv[i], "--settings") == 0) settingsPath = value;
+        else if (strcmp(argv[i], "--out") == 0) outPath = value;
+        else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        i++;
+    }
+    if (frames <= 0 || warmup < 0) {
+        fprintf(stderr, "--frames must be positive and --warmup not negative\n");
+        return EXIT_FAILURE;
+    }
+
+    InputScript script = {0};
+    if (inputPath && !loadScript(&script, inputPath)) {
+        free(script.entries);
+        return EXIT_FAILURE;
+    }
+
+    // No window, no GPU, no vsync, no sound device
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    SDL_SetHint(SDL_HINT_RENDER_VSYNC, "0");
+
+    // Loads only the benchmarked level, the startup trace doesn't include the default one
+    GameManager *gm = GameManager_CreateWithLevel(settingsPath, "Headless benchmark", levelName);
+    if (!gm) {
+        fprintf(stderr, "Failed to initialize GameManager\n");
+        free(script.entries);
+        return EXIT_FAILURE;
+    }
+
+    const char *benchLevel = gm->currentLevelName ? gm->currentLevelName : "?";
+
+    BenchResults results = {0};
+    results.capacity = frames;
+    bool allocated = true;
+    for (int i = 0; i < Counters_Count(); i++) {
+        results.counters[i] = calloc(frames, sizeof(double));
+        if (!results.counters[i]) allocated = false;
+    }
+    results.allocations = calloc(frames, sizeof(double));
+    results.allocatedBytes = calloc(frames, sizeof(double));
+    if (!allocated || !results.allocations || !results.allocatedBytes) {
+        fprintf(stderr, "[Bench] Out of memory\n");
+        freeResults(&results);
+        GameManager_Destroy(gm, EXIT_FAILURE);
+        free(script.entries);
+        return EXIT_FAILURE;
+    }
+
+    // Every frame is exactly one simulation step. The frame time is rounded up to the
+    // next float and the leftover dropped, so no frame runs zero or two steps.
+    int hz = gm->settings.gameplay.simulationHz > 0 ? gm->settings.gameplay.simulationHz : 60;
+    double dt = 1.0 / hz;
+    float frameTime = nextafterf((float)dt, 1.0f);
+
+    Uint8 keys[SDL_NUM_SCANCODES];
+    for (int frame = 0; frame < warmup + frames; frame++) {
+        scriptKeys(&script, frame, &gm->player->controls, keys);
+
+        unsigned long long allocsBefore = __atomic_load_n(&allocCount, __ATOMIC_RELAXED);
+        unsigned long long bytesBefore = __atomic_load_n(&allocBytes, __ATOMIC_RELAXED);
+
+        Profiler_BeginFrame();
+
+        // The counters' totals hold exactly the startup work once the first frame begins
+        if (frame == 0) {
+            for (int i = 0; i < Counters_Count(); i++) {
+                CounterStats stats;
+                Counters_GetStats(i, &stats);
+                results.startupCounters[i] = stats.total;
+            }
+        }
+
+        PROFILE_BEGIN("HandleInput");
+        SDL_PumpEvents();
+        Player_HandleInputState(gm->player, keys);
+        PROFILE_END();
+
+        gm->simAccumulator = 0.0;
+        GameManager_Update(gm, frameTime);
+        GameManager_Render(gm);
+
+        Profiler_EndFrame();
+
+        if (frame < warmup) continue;
+        int index = results.frames++;
+        for (int i = 0; i < Counters_Count(); i++) {
+            CounterStats stats;
+            Counters_GetStats(i, &stats);
+            results.counters[i][index] = (double)stats.last;
+        }
+        results.allocations[index] = (double)(__atomic_load_n(&allocCount, __ATOMIC_RELAXED) - allocsBefore);
+        results.allocatedBytes[index] = (double)(__atomic_load_n(&allocBytes, __ATOMIC_RELAXED) - bytesBefore);
+
+        const ProfileFrame *profiled = Profiler_LastFrame();
+        if (profiled) recordFrame(&results, profiled);
+    }
+
+    bool written = writeResults(&results, outPath, benchLevel, warmup, dt);
+
+    freeResults(&results);
+    free(script.entries);
+    GameManager_Destroy(gm, written ? EXIT_SUCCESS : EXIT_FAILURE);
+    return written ? EXIT_SUCCESS : EXIT_FAILURE;
+}
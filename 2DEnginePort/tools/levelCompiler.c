@@ -0,0 +1,66 @@
+// Offline level compiler: turns a level JSON and its layer CSVs into one .lvlbin
+// that loadLevelFromJSON maps straight into memory.
+//
+// Usage: levelCompiler <level.json> [out.lvlbin]
+//        levelCompiler --all <levelPaths.json>
+//
+// Without an output path the file is written next to the JSON, which is where the loader looks.
+// Paths inside the level are relative to the game's working directory, so run it from there.
+// Builds from the engine sources, `make build/levelCompiler` on Linux.
+
+#define SDL_MAIN_HANDLED
+#include "level.h"
+#include "levelBin.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool compileLevel(const char *jsonPath, const char *outPath)
+{
+    char defaultOut[512];
+    if (!outPath) {
+        if (!LevelBin_PathFor(jsonPath, defaultOut, sizeof(defaultOut))) {
+            fprintf(stderr, "Output path too long for %s\n", jsonPath);
+            return false;
+        }
+        outPath = defaultOut;
+    }
+
+    Level *lvl = level_parseJSON(jsonPath);
+    if (!lvl) {
+        fprintf(stderr, "Failed to parse %s\n", jsonPath);
+        return false;
+    }
+
+    bool ok = LevelBin_Write(lvl, outPath);
+    if (ok) {
+        printf("%s -> %s (%d x %d, %d layers)\n", jsonPath, outPath, lvl->levelColumns, lvl->levelRows, lvl->layerCount);
+    }
+
+    unloadLevel(lvl);
+    free(lvl);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <level.json> [out.lvlbin]\n       %s --all <levelPaths.json>\n", argv[0], argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (strcmp(argv[1], "--all") == 0) {
+        LevelPaths *lp = levelPaths(argc > 2 ? argv[2] : "levelPaths.json");
+        if (!lp) return EXIT_FAILURE;
+
+        int failed = 0;
+        for (int i = 0; i < lp->count; i++) {
+            if (!lp->levels[i].path || !compileLevel(lp->levels[i].path, NULL)) failed++;
+        }
+        freeLevelPaths(lp);
+        return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    return compileLevel(argv[1], argc > 2 ? argv[2] : NULL) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
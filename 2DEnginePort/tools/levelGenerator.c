@@ -0,0 +1,458 @@
+// Synthetic stress level generator.
+// Writes a level JSON the game loads like any other (layer CSVs, tilesets and
+// backgrounds from assets/mapFiles) plus an enemy spawn file, all from a fixed seed so
+// the same parameters always give the same level. With --bin the level is compiled to
+// .lvlbin too, and --register adds it to levelPaths.json so the game and headlessBench
+// can load it by name.
+//
+// Usage: levelGenerator [--name stress] [--out assets/maps/stress] [--columns 1024]
+//                       [--rows 64] [--layers 5] [--density 0.35] [--solid 0.5]
+//                       [--enemies 200] [--seed 1] [--bin] [--register levelPaths.json]
+//
+//   --layers   tile layers, the last one is the collidable foreground (at least 1)
+//   --density  share of cells that hold a tile, per layer
+//   --solid    share of the foreground's tiles that are solid
+//
+// The bottom two rows of the foreground are solid ground and the spawn column is kept
+// clear above it, so the player always has somewhere to stand.
+// Run it from the game's working directory. Builds from the engine sources like
+// levelCompiler, `make build/levelGenerator` on Linux.
+
+#define SDL_MAIN_HANDLED
+#include "level.h"
+#include "levelBin.h"
+#include "cJSON.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#ifdef _WIN32
+#include <direct.h>
+#define makeDirectory(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define makeDirectory(path) mkdir(path, 0755)
+#endif
+
+#define GEN_PATH_MAX 512
+#define GEN_GROUND_ROWS 2
+#define GEN_SPAWN_COLUMN 5
+
+typedef struct {
+    const char *id;
+    const char *image;
+    int tilesPerRow;
+    int tileCount;          // tiles in the image, ids are 0..tileCount-1
+} GenTileset;
+
+// Same images and tile size as tmpLevel
+static const GenTileset tilesets[] = {
+    {"mainTiles", "assets/mapFiles/Tileset.png", 8, 48},
+    {"props", "assets/mapFiles/props.png", 26, 364},
+    {"decor", "assets/mapFiles/Decors.png", 14, 98},
+};
+#define GEN_TILESET_COUNT ((int)(sizeof(tilesets) / sizeof(tilesets[0])))
+
+// Foreground tiles from Tileset.png that collide, the rest of its tiles don't
+static const int solidTiles[] = {0, 1, 2, 5, 9};
+#define GEN_SOLID_COUNT ((int)(sizeof(solidTiles) / sizeof(solidTiles[0])))
+
+static const char *enemyTypes[] = {"goblin", "mushroom", "skeleton", "flying_eye"};
+#define GEN_ENEMY_TYPES ((int)(sizeof(enemyTypes) / sizeof(enemyTypes[0])))
+
+typedef struct {
+    const char *name;
+    const char *outDir;
+    const char *registerPath;
+    int columns, rows, layers, enemies;
+    float density, solidRatio;
+    unsigned int seed;
+    bool compile;
+} GenOptions;
+
+// Fixed-seed xorshift, same generator as csvBench
+static unsigned int rngState;
+static unsigned int rngNext(void)
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static float rngFloat(void)
+{
+    return (rngNext() >> 8) * (1.0f / 16777216.0f);
+}
+
+static int rngRange(int count)
+{
+    return count > 0 ? (int)(rngNext() % (unsigned int)count) : 0;
+}
+
+static bool isSolid(int id)
+{
+    for (int i = 0; i < GEN_SOLID_COUNT; i++) {
+        if (solidTiles[i] == id) return true;
+    }
+    return false;
+}
+
+static int nonSolidTile(void)
+{
+    int id;
+    do {
+        id = rngRange(tilesets[0].tileCount);
+    } while (isSolid(id));
+    return id;
+}
+
+static void fillDecorLayer(int *tiles, const GenOptions *opt, const GenTileset *tileset)
+{
+    for (int i = 0; i < opt->rows * opt->columns; i++) {
+        tiles[i] = rngFloat() < opt->density ? rngRange(tileset->tileCount) : -1;
+    }
+}
+
+static void fillForeground(int *tiles, const GenOptions *opt)
+{
+    int spawnColumn = SDL_min(GEN_SPAWN_COLUMN, opt->columns - 1);
+    for (int r = 0; r < opt->rows; r++) {
+        for (int c = 0; c < opt->columns; c++) {
+            int *tile = &tiles[r * opt->columns + c];
+            if (r >= opt->rows - GEN_GROUND_ROWS) {
+                *tile = solidTiles[rngRange(GEN_SOLID_COUNT)];
+            }
+            else if (c == spawnColumn || rngFloat() >= opt->density) {
+                *tile = -1;
+            }
+            else {
+                *tile = rngFloat() < opt->solidRatio ? solidTiles[rngRange(GEN_SOLID_COUNT)] : nonSolidTile();
+            }
+        }
+    }
+}
+
+static bool writeCSV(const char *path, const int *tiles, int rows, int columns)
+{
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Failed to open %s for writing\n", path);
+        return false;
+    }
+
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < columns; c++) {
+            fprintf(file, c + 1 < columns ? "%d," : "%d\n", tiles[r * columns + c]);
+        }
+    }
+
+    bool ok = !ferror(file);
+    if (fclose(file) != 0) ok = false;
+    if (!ok) fprintf(stderr, "Failed writing %s\n", path);
+    return ok;
+}
+
+static bool writeJSON(const char *path, cJSON *root)
+{
+    char *text = cJSON_Print(root);
+    if (!text) return false;
+
+    FILE *file = fopen(path, "w");
+    bool ok = file && fputs(text, file) >= 0;
+    if (file && fclose(file) != 0) ok = false;
+    if (!ok) fprintf(stderr, "Failed writing %s\n", path);
+    free(text);
+    return ok;
+}
+
+// Enemies stand on the ground, spread over the level but away from the spawn
+static bool writeEnemies(const char *path, const GenOptions *opt)
+{
+    cJSON *root = cJSON_CreateObject();
+    cJSON *list = cJSON_AddArrayToObject(root, "enemies");
+    if (!list) {
+        cJSON_Delete(root);
+        return false;
+    }
+
+    int tilePixels = (int)(16 * 2.5f);
+    int groundY = (opt->rows - GEN_GROUND_ROWS) * tilePixels;
+    int minX = (GEN_SPAWN_COLUMN + 10) * tilePixels;
+    int maxX = SDL_max(opt->columns * tilePixels - tilePixels, minX + 1);
+
+    for (int i = 0; i < opt->enemies; i++) {
+        const char *type = enemyTypes[i % GEN_ENEMY_TYPES];
+        int x = minX + rngRange(maxX - minX);
+        bool flying = strcmp(type, "flying_eye") == 0;
+
+        cJSON *enemy = cJSON_CreateObject();
+        cJSON_AddStringToObject(enemy, "type", type);
+        cJSON_AddNumberToObject(enemy, "x", x);
+        cJSON_AddNumberToObject(enemy, "y", flying ? groundY - 4 * tilePixels : groundY - tilePixels);
+        cJSON_AddStringToObject(enemy, "facing", rngNext() & 1 ? "left" : "right");
+
+        cJSON *params = cJSON_AddObjectToObject(enemy, "params");
+        cJSON_AddNumberToObject(params, "patrolLeft", SDL_max(x - 150, 0));
+        cJSON_AddNumberToObject(params, "patrolRight", x + 150);
+        cJSON_AddNumberToObject(params, "health", 20 + rngRange(20));
+        cJSON_AddItemToArray(list, enemy);
+    }
+
+    bool ok = writeJSON(path, root);
+    cJSON_Delete(root);
+    return ok;
+}
+
+// snprintf's result, false (with a message) when the path didn't fit
+static bool pathFits(int written, size_t size, const char *path)
+{
+    if (written >= 0 && (size_t)written < size) return true;
+    fprintf(stderr, "Path too long: %s...\n", path);
+    return false;
+}
+
+static bool writeLevel(const GenOptions *opt, char *jsonPath, size_t jsonPathSize)
+{
+    char csvPath[GEN_PATH_MAX];
+    char enemyPath[GEN_PATH_MAX];
+    size_t cells = (size_t)opt->rows * opt->columns;
+
+    if (!pathFits(snprintf(jsonPath, jsonPathSize, "%s/%s.json", opt->outDir, opt->name), jsonPathSize, jsonPath) ||
+        !pathFits(snprintf(enemyPath, sizeof(enemyPath), "%s/enemies_%s.json", opt->outDir, opt->name),
+                  sizeof(enemyPath), enemyPath)) {
+        return false;
+    }
+
+    int *tiles = malloc(cells * sizeof(int));
+    cJSON *root = cJSON_CreateObject();
+    if (!tiles || !root) {
+        fprintf(stderr, "Out of memory\n");
+        free(tiles);
+        cJSON_Delete(root);
+        return false;
+    }
+
+    cJSON_AddStringToObject(root, "levelName", opt->name);
+    cJSON_AddNumberToObject(root, "spawnColumn", SDL_min(GEN_SPAWN_COLUMN, opt->columns - 1));
+    cJSON_AddNumberToObject(root, "levelColumns", opt->columns);
+    cJSON_AddNumberToObject(root, "levelRows", opt->rows);
+    cJSON_AddBoolToObject(root, "hasEnemies", opt->enemies > 0);
+    cJSON_AddStringToObject(root, "enemyPath", enemyPath);
+
+    cJSON *tilesetList = cJSON_AddArrayToObject(root, "tilesets");
+    for (int i = 0; i < GEN_TILESET_COUNT; i++) {
+        cJSON *ts = cJSON_CreateObject();
+        cJSON_AddStringToObject(ts, "id", tilesets[i].id);
+        cJSON_AddStringToObject(ts, "image", tilesets[i].image);
+        cJSON_AddNumberToObject(ts, "tileSize", 16);
+        cJSON_AddNumberToObject(ts, "tilesPerRow", tilesets[i].tilesPerRow);
+        cJSON_AddNumberToObject(ts, "scale", 2.5);
+        cJSON_AddItemToArray(tilesetList, ts);
+    }
+
+    bool ok = true;
+    cJSON *layerList = cJSON_AddArrayToObject(root, "layers");
+    for (int i = 0; ok && i < opt->layers; i++) {
+        bool foreground = i == opt->layers - 1;
+        // Decor layers cycle through the tilesets so drawing switches textures like a real level
+        const GenTileset *tileset = foreground ? &tilesets[0] : &tilesets[(i + 1) % GEN_TILESET_COUNT];
+
+        char layerName[32];
+        if (foreground) snprintf(layerName, sizeof(layerName), "foreground");
+        else snprintf(layerName, sizeof(layerName), "decor%d", i);
+        if (!pathFits(snprintf(csvPath, sizeof(csvPath), "%s/%s_%s.csv", opt->outDir, opt->name, layerName),
+                      sizeof(csvPath), csvPath)) {
+            ok = false;
+            break;
+        }
+
+        if (foreground) fillForeground(tiles, opt);
+        else fillDecorLayer(tiles, opt, tileset);
+        ok = writeCSV(csvPath, tiles, opt->rows, opt->columns);
+
+        cJSON *layer = cJSON_CreateObject();
+        cJSON_AddStringToObject(layer, "name", layerName);
+        cJSON_AddStringToObject(layer, "csv", csvPath);
+        cJSON_AddStringToObject(layer, "tileset", tileset->id);
+        cJSON_AddBoolToObject(layer, "collidable", foreground);
+        if (foreground) {
+            cJSON_AddItemToObject(layer, "solidTiles", cJSON_CreateIntArray(solidTiles, GEN_SOLID_COUNT));
+        }
+        cJSON_AddItemToArray(layerList, layer);
+    }
+
+    static const struct { const char *image; double scrollSpeed, offsetY; } backgrounds[] = {
+        {"assets/mapFiles/BG1.png", 0.3, 0},
+        {"assets/mapFiles/BG2.png", 0.4, -35},
+        {"assets/mapFiles/BG3.png", 0.5, -50},
+    };
+    cJSON *bgList = cJSON_AddArrayToObject(root, "backgrounds");
+    for (int i = 0; i < 3; i++) {
+        cJSON *bg = cJSON_CreateObject();
+        cJSON_AddStringToObject(bg, "image", backgrounds[i].image);
+        cJSON_AddNumberToObject(bg, "scrollSpeed", backgrounds[i].scrollSpeed);
+        cJSON_AddNumberToObject(bg, "scale", 1.0);
+        cJSON_AddNumberToObject(bg, "offsetY", backgrounds[i].offsetY);
+        cJSON_AddItemToArray(bgList, bg);
+    }
+
+    if (ok) ok = writeEnemies(enemyPath, opt);
+    if (ok) ok = writeJSON(jsonPath, root);
+
+    cJSON_Delete(root);
+    free(tiles);
+    return ok;
+}
+
+// Adds the level to levelPaths.json, or points an existing entry of the same name at it
+static bool registerLevel(const char *levelPathsFile, const char *name, const char *jsonPath)
+{
+    FILE *file = fopen(levelPathsFile, "rb");
+    if (!file) {
+        fprintf(stderr, "Failed to open %s\n", levelPathsFile);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *text = size > 0 ? malloc((size_t)size + 1) : NULL;
+    bool read = text && fread(text, 1, (size_t)size, file) == (size_t)size;
+    fclose(file);
+    if (!read) {
+        fprintf(stderr, "Failed to read %s\n", levelPathsFile);
+        free(text);
+        return false;
+    }
+    text[size] = '\0';
+
+    cJSON *root = cJSON_Parse(text);
+    free(text);
+    cJSON *levels = cJSON_GetObjectItemCaseSensitive(root, "levels");
+    if (!cJSON_IsArray(levels)) {
+        fprintf(stderr, "%s has no \"levels\" array\n", levelPathsFile);
+        cJSON_Delete(root);
+        return false;
+    }
+
+    cJSON *entry = NULL;
+    cJSON_ArrayForEach(entry, levels) {
+        cJSON *entryName = cJSON_GetObjectItemCaseSensitive(entry, "name");
+        if (cJSON_IsString(entryName) && strcmp(entryName->valuestring, name) == 0) break;
+    }
+    if (entry) {
+        cJSON_ReplaceItemInObjectCaseSensitive(entry, "path", cJSON_CreateString(jsonPath));
+    }
+    else {
+        entry = cJSON_CreateObject();
+        cJSON_AddStringToObject(entry, "name", name);
+        cJSON_AddStringToObject(entry, "path", jsonPath);
+        cJSON_AddItemToArray(levels, entry);
+    }
+
+    bool ok = writeJSON(levelPathsFile, root);
+    cJSON_Delete(root);
+    return ok;
+}
+
+static bool compileLevel(const char *jsonPath)
+{
+    char binPath[GEN_PATH_MAX];
+    if (!LevelBin_PathFor(jsonPath, binPath, sizeof(binPath))) {
+        fprintf(stderr, "Output path too long for %s\n", jsonPath);
+        return false;
+    }
+
+    Level *lvl = level_parseJSON(jsonPath);
+    if (!lvl) {
+        fprintf(stderr, "Failed to parse %s\n", jsonPath);
+        return false;
+    }
+
+    bool ok = LevelBin_Write(lvl, binPath);
+    if (ok) printf("Compiled %s\n", binPath);
+    unloadLevel(lvl);
+    free(lvl);
+    return ok;
+}
+
+static bool parseOptions(int argc, char *argv[], GenOptions *opt)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--bin") == 0) {
+            opt->compile = true;
+            continue;
+        }
+
+        const char *value = i + 1 < argc ? argv[++i] : NULL;
+        if (!value) {
+            fprintf(stderr, "Missing value for %s\n", arg);
+            return false;
+        }
+        if (strcmp(arg, "--name") == 0) opt->name = value;
+        else if (strcmp(arg, "--out") == 0) opt->outDir = value;
+        else if (strcmp(arg, "--register") == 0) opt->registerPath = value;
+        else if (strcmp(arg, "--columns") == 0) opt->columns = atoi(value);
+        else if (strcmp(arg, "--rows") == 0) opt->rows = atoi(value);
+        else if (strcmp(arg, "--layers") == 0) opt->layers = atoi(value);
+        else if (strcmp(arg, "--enemies") == 0) opt->enemies = atoi(value);
+        else if (strcmp(arg, "--density") == 0) opt->density = (float)atof(value);
+        else if (strcmp(arg, "--solid") == 0) opt->solidRatio = (float)atof(value);
+        else if (strcmp(arg, "--seed") == 0) opt->seed = (unsigned int)strtoul(value, NULL, 10);
+        else {
+            fprintf(stderr, "Unknown option %s\n", arg);
+            return false;
+        }
+    }
+
+    if (opt->columns <= GEN_SPAWN_COLUMN || opt->rows <= GEN_GROUND_ROWS || opt->layers < 1 || opt->enemies < 0 ||
+        opt->density < 0.0f || opt->density > 1.0f || opt->solidRatio < 0.0f || opt->solidRatio > 1.0f) {
+        fprintf(stderr, "Need columns > %d, rows > %d, layers >= 1, enemies >= 0, density and solid in 0..1\n",
+                GEN_SPAWN_COLUMN, GEN_GROUND_ROWS);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    GenOptions opt = {
+        .name = "stress",
+        .outDir = NULL,
+        .columns = 1024,
+        .rows = 64,
+        .layers = 5,
+        .enemies = 200,
+        .density = 0.35f,
+        .solidRatio = 0.5f,
+        .seed = 1,
+    };
+    if (!parseOptions(argc, argv, &opt)) return EXIT_FAILURE;
+
+    char defaultDir[GEN_PATH_MAX];
+    if (!opt.outDir) {
+        if (!pathFits(snprintf(defaultDir, sizeof(defaultDir), "assets/maps/%s", opt.name), sizeof(defaultDir),
+                      defaultDir)) {
+            return EXIT_FAILURE;
+        }
+        opt.outDir = defaultDir;
+    }
+    if (makeDirectory(opt.outDir) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Failed to create %s\n", opt.outDir);
+        return EXIT_FAILURE;
+    }
+
+    // xorshift never leaves zero
+    rngState = opt.seed ? opt.seed : 0x2D3E4F5Au;
+
+    char jsonPath[GEN_PATH_MAX];
+    if (!writeLevel(&opt, jsonPath, sizeof(jsonPath))) return EXIT_FAILURE;
+    printf("%s: %d x %d, %d layers, %d enemies, seed %u\n", jsonPath, opt.columns, opt.rows, opt.layers, opt.enemies, opt.seed);
+
+    if (opt.compile && !compileLevel(jsonPath)) return EXIT_FAILURE;
+    if (opt.registerPath && !registerLevel(opt.registerPath, opt.name, jsonPath)) return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}